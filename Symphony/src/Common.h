@@ -1,16 +1,23 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <type_traits>
 
 #include "Logger.h"
 #include "Util/Exception.h"
 #include "Util/YCombinator.h"
 
-#ifdef SYMPHONY_BUILD_DLL
-   #define SYMPHONY_API __declspec(dllexport)
+#if defined(_WIN32)
+   #ifdef SYMPHONY_BUILD_DLL
+      #define SYMPHONY_API __declspec(dllexport)
+   #else
+      #define SYMPHONY_API __declspec(dllimport)
+   #endif
 #else
-   #define SYMPHONY_API __declspec(dllimport)
+   #define SYMPHONY_API __attribute__((visibility("default")))
 #endif
 
 namespace Symphony
@@ -25,10 +32,13 @@ namespace Symphony
    template<typename T>
    concept Component = std::is_class_v<T> && std::is_default_constructible_v<T>;
 
+   template<typename Alloc, typename T>
+   using RebindAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
    template <typename Alloc>
    concept Allocator = requires(Alloc a, typename Alloc::value_type * p, size_t n)
    {
-      typename Alloc::template rebind_alloc<int>;
+      typename RebindAlloc<Alloc, int>;
 
       { a.allocate(n) } -> std::same_as<typename Alloc::value_type*>;
       { a.deallocate(p, n) } -> std::same_as<void>;
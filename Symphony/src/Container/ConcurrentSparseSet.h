@@ -0,0 +1,289 @@
+#pragma once
+
+#include "../Common.h"
+#include "../Util/Epoch.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace Symphony
+{
+   // Thread safe counterpart of SparseSet.
+   //
+   // Contains and Get are wait-free: they follow two atomically published directory levels down to a page of atomic
+   // values and never take a lock. Pages are only ever added, never moved or freed while the set is alive.
+   //
+   // Writers lock one shard, selected by the key's page (key >> SPARSE_BUCKET_SHIFT), so writers touching different
+   // pages rarely contend. Each shard owns the dense key array for its pages, which keeps swap-and-pop removal inside a
+   // single lock. When a dense array grows the old block is retired through an EpochManager, readers that are still
+   // walking it keep a valid snapshot until they unpin.
+   template<typename Key = Entity, typename Value = size_t>
+   class ConcurrentSparseSet
+   {
+      static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key> && sizeof(Key) <= sizeof(uint32_t), "ConcurrentSparseSet: Key type must be an unsigned integer of at most 32 bits.");
+      static_assert(std::is_arithmetic_v<Value>, "ConcurrentSparseSet: Value type must be a primitive type.");
+      static_assert(std::atomic<Value>::is_always_lock_free, "ConcurrentSparseSet: Value type must be lock free when atomic.");
+
+      static constexpr size_t SPARSE_BUCKET_SHIFT = 10;
+      static constexpr size_t SPARSE_BUCKET_SIZE = 1 << SPARSE_BUCKET_SHIFT;
+
+      static constexpr size_t DIRECTORY_SHIFT = 11;
+      static constexpr size_t DIRECTORY_SIZE = 1 << DIRECTORY_SHIFT;
+
+      static constexpr size_t SHARD_COUNT = 64;
+      static constexpr size_t INITIAL_SHARD_CAPACITY = 64;
+
+      struct Page
+      {
+         Page()
+         {
+            for (auto& value : values)
+               value.store(InvalidValue, std::memory_order_relaxed);
+         }
+
+         std::array<std::atomic<Value>, SPARSE_BUCKET_SIZE> values;
+         std::array<uint32_t, SPARSE_BUCKET_SIZE> denseIndices = {}; // Only touched by the owning shard's writer
+      };
+
+      struct Directory
+      {
+         std::array<std::atomic<Page*>, DIRECTORY_SIZE> pages = {};
+      };
+
+      struct alignas(64) Shard
+      {
+         std::mutex mutex;
+         std::atomic<std::atomic<Key>*> dense = nullptr;
+         std::atomic<size_t> size = 0;
+         size_t capacity = 0;
+      };
+
+   public:
+      static constexpr Value InvalidValue = std::numeric_limits<Value>::max();
+
+      ConcurrentSparseSet() = default;
+
+      ~ConcurrentSparseSet()
+      {
+         for (auto& directory : m_directories)
+         {
+            Directory* dir = directory.load(std::memory_order_relaxed);
+            if (!dir)
+               continue;
+
+            for (auto& page : dir->pages)
+               delete page.load(std::memory_order_relaxed);
+            delete dir;
+         }
+
+         for (auto& shard : m_shards)
+            delete[] shard.dense.load(std::memory_order_relaxed);
+      }
+
+      ConcurrentSparseSet(const ConcurrentSparseSet&) = delete;
+      ConcurrentSparseSet& operator=(const ConcurrentSparseSet&) = delete;
+
+      // Returns false if the key is already present or value is InvalidValue
+      bool Insert(Key key, Value value)
+      {
+         if (value == InvalidValue) [[unlikely]]
+            return false;
+
+         auto [pageIndex, offset] = GetPageIndexAndOffset(key);
+         Shard& shard = GetShard(pageIndex);
+         std::lock_guard lock(shard.mutex);
+
+         Page* page = GetOrCreatePage(pageIndex);
+         if (page->values[offset].load(std::memory_order_relaxed) != InvalidValue)
+            return false;
+
+         size_t size = shard.size.load(std::memory_order_relaxed);
+         if (size == shard.capacity)
+            Grow(shard);
+
+         shard.dense.load(std::memory_order_relaxed)[size].store(key, std::memory_order_relaxed);
+         page->denseIndices[offset] = static_cast<uint32_t>(size);
+         shard.size.store(size + 1, std::memory_order_release);
+
+         page->values[offset].store(value, std::memory_order_release);
+         return true;
+      }
+
+      // Overwrites the value of a present key, returns false if the key is absent
+      bool Set(Key key, Value value)
+      {
+         if (value == InvalidValue) [[unlikely]]
+            return false;
+
+         auto [pageIndex, offset] = GetPageIndexAndOffset(key);
+         Shard& shard = GetShard(pageIndex);
+         std::lock_guard lock(shard.mutex);
+
+         Page* page = FindPage(pageIndex);
+         if (!page || page->values[offset].load(std::memory_order_relaxed) == InvalidValue)
+            return false;
+
+         page->values[offset].store(value, std::memory_order_release);
+         return true;
+      }
+
+      bool Remove(Key key)
+      {
+         auto [pageIndex, offset] = GetPageIndexAndOffset(key);
+         Shard& shard = GetShard(pageIndex);
+         std::lock_guard lock(shard.mutex);
+
+         Page* page = FindPage(pageIndex);
+         if (!page || page->values[offset].load(std::memory_order_relaxed) == InvalidValue)
+            return false;
+
+         // Readers resolve through the page first, so unpublish before touching the dense array
+         page->values[offset].store(InvalidValue, std::memory_order_release);
+
+         std::atomic<Key>* dense = shard.dense.load(std::memory_order_relaxed);
+         size_t last = shard.size.load(std::memory_order_relaxed) - 1;
+         uint32_t removedIndex = page->denseIndices[offset];
+
+         // If target key is not last in the shard's dense array, swap it with the last key to maintain dense packing
+         if (removedIndex != last)
+         {
+            Key lastKey = dense[last].load(std::memory_order_relaxed);
+            dense[removedIndex].store(lastKey, std::memory_order_relaxed);
+
+            auto [lastPageIndex, lastOffset] = GetPageIndexAndOffset(lastKey);
+            FindPage(lastPageIndex)->denseIndices[lastOffset] = removedIndex;
+         }
+
+         shard.size.store(last, std::memory_order_release);
+         return true;
+      }
+
+      [[nodiscard]] bool Contains(Key key) const { return Get(key) != InvalidValue; }
+
+      [[nodiscard]] Value Get(Key key) const
+      {
+         auto [pageIndex, offset] = GetPageIndexAndOffset(key);
+         const Page* page = FindPage(pageIndex);
+         if (!page)
+            return InvalidValue;
+         return page->values[offset].load(std::memory_order_acquire);
+      }
+
+      Value operator[](Key key) const { return Get(key); }
+
+      // Weakly consistent traversal: every key that stays present for the whole call is visited at least once, keys
+      // inserted or removed concurrently may or may not be. func receives (key, value).
+      template<typename Func>
+      void ForEach(Func&& func)
+      {
+         EpochManager::Guard guard(m_epochs);
+
+         for (auto& shard : m_shards)
+         {
+            // Size before pointer: a grown block always holds at least as many keys as the size read before it
+            size_t size = shard.size.load(std::memory_order_acquire);
+            std::atomic<Key>* dense = shard.dense.load();
+            if (!dense)
+               continue;
+
+            // Walk backwards, a concurrent swap-and-pop only ever moves a key from a visited slot to an unvisited one
+            for (size_t i = size; i-- > 0;)
+            {
+               Key key = dense[i].load(std::memory_order_relaxed);
+               Value value = Get(key);
+               if (value != InvalidValue)
+                  func(key, value);
+            }
+         }
+      }
+
+      void Clear()
+      {
+         for (auto& shard : m_shards)
+         {
+            std::lock_guard lock(shard.mutex);
+
+            std::atomic<Key>* dense = shard.dense.load(std::memory_order_relaxed);
+            size_t size = shard.size.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < size; ++i)
+            {
+               auto [pageIndex, offset] = GetPageIndexAndOffset(dense[i].load(std::memory_order_relaxed));
+               FindPage(pageIndex)->values[offset].store(InvalidValue, std::memory_order_release);
+            }
+            shard.size.store(0, std::memory_order_release);
+         }
+      }
+
+      // Approximate while writers are active
+      size_t Size() const
+      {
+         size_t size = 0;
+         for (auto& shard : m_shards)
+            size += shard.size.load(std::memory_order_relaxed);
+         return size;
+      }
+
+   private:
+      [[nodiscard]] static inline std::pair<size_t, size_t> GetPageIndexAndOffset(Key key) { return { size_t(key) >> SPARSE_BUCKET_SHIFT, size_t(key) & (SPARSE_BUCKET_SIZE - 1) }; }
+
+      inline Shard& GetShard(size_t pageIndex) { return m_shards[pageIndex & (SHARD_COUNT - 1)]; }
+
+      [[nodiscard]] Page* FindPage(size_t pageIndex) const
+      {
+         Directory* directory = m_directories[pageIndex >> DIRECTORY_SHIFT].load(std::memory_order_acquire);
+         if (!directory)
+            return nullptr;
+         return directory->pages[pageIndex & (DIRECTORY_SIZE - 1)].load(std::memory_order_acquire);
+      }
+
+      // Caller holds the shard lock for pageIndex
+      Page* GetOrCreatePage(size_t pageIndex)
+      {
+         auto& directorySlot = m_directories[pageIndex >> DIRECTORY_SHIFT];
+         Directory* directory = directorySlot.load(std::memory_order_acquire);
+         if (!directory) [[unlikely]]
+         {
+            // Directories are shared between shards, so publication races are settled with a CAS
+            auto newDirectory = std::make_unique<Directory>();
+            if (directorySlot.compare_exchange_strong(directory, newDirectory.get(), std::memory_order_acq_rel))
+               directory = newDirectory.release();
+         }
+
+         auto& pageSlot = directory->pages[pageIndex & (DIRECTORY_SIZE - 1)];
+         Page* page = pageSlot.load(std::memory_order_relaxed);
+         if (!page) [[unlikely]]
+         {
+            page = new Page();
+            pageSlot.store(page, std::memory_order_release);
+         }
+         return page;
+      }
+
+      // Caller holds the shard lock
+      void Grow(Shard& shard)
+      {
+         size_t newCapacity = shard.capacity ? shard.capacity * 2 : INITIAL_SHARD_CAPACITY;
+         auto* newDense = new std::atomic<Key>[newCapacity];
+
+         std::atomic<Key>* oldDense = shard.dense.load(std::memory_order_relaxed);
+         size_t size = shard.size.load(std::memory_order_relaxed);
+         for (size_t i = 0; i < size; ++i)
+            newDense[i].store(oldDense[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+         shard.dense.store(newDense);
+         shard.capacity = newCapacity;
+
+         if (oldDense)
+            m_epochs.Retire(oldDense);
+      }
+
+      std::array<std::atomic<Directory*>, DIRECTORY_SIZE> m_directories = {};
+      std::array<Shard, SHARD_COUNT> m_shards;
+      EpochManager m_epochs;
+   };
+}
@@ -40,6 +40,18 @@ namespace Symphony
          m_keyToIndex.erase(key);
       }
 
+      void Swap(size_t indexA, size_t indexB)
+      {
+         assert(indexA < m_components.size() && indexB < m_components.size() && "Index out of range");
+         if (indexA == indexB)
+            return;
+
+         std::swap(m_components[indexA], m_components[indexB]);
+         std::swap(m_indexToKey[indexA], m_indexToKey[indexB]);
+         m_keyToIndex[m_indexToKey[indexA]] = indexA;
+         m_keyToIndex[m_indexToKey[indexB]] = indexB;
+      }
+
       Comp& Get(Key key)
       {
          assert(m_keyToIndex.find(key) != m_keyToIndex.end() && "Key does not exist in DenseArray");
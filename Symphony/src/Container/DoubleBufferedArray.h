@@ -0,0 +1,260 @@
+#pragma once
+
+#include "../Common.h"
+#include "PackedArray.h"
+#include "../Util/AlignedAllocator.h"
+#include "../Util/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Symphony
+{
+   // PackedArray with double buffered read access for pipelining simulation and extraction.
+   //
+   // One thread (the simulation) owns the live PackedArray and writes it through this class, which records the pages of
+   // the dense range it touches. Publish() is the sync point: it brings the back buffer up to date by copying only the
+   // pages written since that buffer was last published, then flips it to the front. Any number of other threads call
+   // AcquireRead() to pin the front buffer, so extraction of frame N can run while frame N+1 is being simulated.
+   //
+   // Guarantees for a ReadHandle:
+   //    - It sees exactly the entity set and component values the live array held when the Publish() that produced its
+   //      buffer was called, never a mix of two frames.
+   //    - Its contents do not change until it is released, later Publish() calls write the other buffer.
+   //    - If a handle is held across two Publish() calls, the second one waits for it to be released. That is the only
+   //      point where the simulation can stall on a reader.
+   //
+   // Entities index a flat lookup table in each buffer, so they are expected to be small and dense like the registry's.
+   template<typename Entity, Component Comp>
+   class DoubleBufferedArray
+   {
+      static constexpr size_t NULL_INDEX = ~size_t(0);
+      static constexpr size_t PAGE_SIZE = std::max<size_t>(1, 4096 / sizeof(Comp));
+
+      struct Buffer
+      {
+         std::vector<Entity> entities;
+         std::vector<Comp, AlignedAllocator<Comp>> components;
+         std::vector<size_t> indices; // entity -> dense index, NULL_INDEX if absent
+         size_t size = 0;
+         uint64_t frame = 0;
+      };
+
+   public:
+      class ReadHandle
+      {
+      public:
+         ReadHandle(ReadHandle&& other) noexcept :
+            m_owner(std::exchange(other.m_owner, nullptr)),
+            m_bufferIndex(other.m_bufferIndex)
+         {}
+
+         ~ReadHandle()
+         {
+            if (m_owner)
+               m_owner->m_readers[m_bufferIndex].fetch_sub(1, std::memory_order_release);
+         }
+
+         ReadHandle(const ReadHandle&) = delete;
+         ReadHandle& operator=(const ReadHandle&) = delete;
+         ReadHandle& operator=(ReadHandle&&) = delete;
+
+         // Frame whose Publish() produced this handle's contents, frames count from 1 and 0 means nothing was published
+         uint64_t Frame() const { return GetBuffer().frame; }
+
+         size_t Size() const { return GetBuffer().size; }
+
+         bool Contains(Entity entity) const
+         {
+            const Buffer& buffer = GetBuffer();
+            return entity < buffer.indices.size() && buffer.indices[entity] != NULL_INDEX;
+         }
+
+         // Returns nullptr if entity was not present at the observed Publish()
+         const Comp* Get(Entity entity) const
+         {
+            const Buffer& buffer = GetBuffer();
+            if (entity >= buffer.indices.size() || buffer.indices[entity] == NULL_INDEX)
+               return nullptr;
+            return &buffer.components[buffer.indices[entity]];
+         }
+
+         const Comp& GetByIndex(size_t index) const { return GetBuffer().components[index]; }
+
+         Entity GetEntityAtIndex(size_t index) const { return GetBuffer().entities[index]; }
+
+         template<typename Func>
+         void ForEach(Func&& func) const
+         {
+            const Buffer& buffer = GetBuffer();
+            for (size_t i = 0; i < buffer.size; ++i)
+               func(buffer.entities[i], buffer.components[i]);
+         }
+
+      private:
+         ReadHandle(const DoubleBufferedArray* owner, size_t bufferIndex) :
+            m_owner(owner),
+            m_bufferIndex(bufferIndex)
+         {}
+
+         const Buffer& GetBuffer() const { return m_owner->m_buffers[m_bufferIndex]; }
+
+         friend class DoubleBufferedArray;
+
+         const DoubleBufferedArray* m_owner;
+         size_t m_bufferIndex;
+      };
+
+      void Add(Entity entity, const Comp& component)
+      {
+         if (m_live.Contains(entity))
+            return;
+
+         m_live.Add(entity, component);
+         MarkDirty(m_live.Size() - 1);
+      }
+
+      void Remove(Entity entity)
+      {
+         if (!m_live.Contains(entity))
+            return;
+
+         // The last element is swapped into the vacated slot, the old last slot falls off the end
+         size_t index = m_live.GetIndex(entity);
+         m_live.Remove(entity);
+         if (index < m_live.Size())
+            MarkDirty(index);
+      }
+
+      // Mutable access marks the element's page dirty, use Read() for lookups that do not write
+      Comp& Get(Entity entity)
+      {
+         if (m_live.Contains(entity))
+            MarkDirty(m_live.GetIndex(entity));
+         return m_live.Get(entity);
+      }
+
+      Comp& GetByIndex(size_t index)
+      {
+         MarkDirty(index);
+         return m_live.GetByIndex(index);
+      }
+
+      const Comp& Read(Entity entity) { return m_live.Get(entity); }
+
+      bool Contains(Entity entity) const { return m_live.Contains(entity); }
+
+      Entity GetEntityAtIndex(size_t index) { return m_live.GetEntityAtIndex(index); }
+
+      size_t Size() const { return m_live.Size(); }
+
+      // Marks every page dirty, for systems that rewrite the whole pool anyway
+      template<typename Func>
+      void ParallelForEach(Func&& func, ThreadPool& pool = ThreadPool::Shared())
+      {
+         MarkDirty(0, m_live.Size());
+         Symphony::ParallelForEach(m_live, std::forward<Func>(func), pool);
+      }
+
+      // Marks [begin, end) of the dense range as written this frame, for writes made through references kept from an
+      // earlier Get()
+      void MarkDirty(size_t begin, size_t end)
+      {
+         if (begin >= end)
+            return;
+
+         size_t lastPage = (end - 1) / PAGE_SIZE;
+         if (lastPage >= m_pageFrames.size())
+            m_pageFrames.resize(lastPage + 1, 0);
+         std::fill(m_pageFrames.begin() + begin / PAGE_SIZE, m_pageFrames.begin() + lastPage + 1, m_frame);
+      }
+
+      // Sync point, called by the writing thread once a frame's writes are complete
+      void Publish()
+      {
+         size_t back = m_front.load(std::memory_order_relaxed) ^ 1;
+
+         // Only blocks if a reader still holds the handle it acquired before the previous Publish(). Sequentially
+         // consistent, pairs with the increment and front re-check in AcquireRead()
+         while (m_readers[back].load() != 0)
+            std::this_thread::yield();
+
+         Update(m_buffers[back]);
+         m_front.store(back);
+         ++m_frame;
+      }
+
+      [[nodiscard]] ReadHandle AcquireRead() const
+      {
+         for (;;)
+         {
+            size_t front = m_front.load();
+            m_readers[front].fetch_add(1);
+
+            // The buffer may have become the back buffer between the two steps, Publish() could be writing it
+            if (m_front.load() == front)
+               return ReadHandle(this, front);
+
+            m_readers[front].fetch_sub(1, std::memory_order_release);
+         }
+      }
+
+   private:
+      void MarkDirty(size_t index) { MarkDirty(index, index + 1); }
+
+      // Copies every page written since buffer was last published and fixes up its entity lookup for those slots
+      void Update(Buffer& buffer)
+      {
+         size_t size = m_live.Size();
+
+         // Slots past the new end drop their entity, unless it already moved to a slot below
+         for (size_t i = size; i < buffer.size; ++i)
+         {
+            Entity entity = buffer.entities[i];
+            if (buffer.indices[entity] == i)
+               buffer.indices[entity] = NULL_INDEX;
+         }
+
+         buffer.entities.resize(size);
+         buffer.components.resize(size);
+
+         for (size_t page = 0; page < m_pageFrames.size(); ++page)
+         {
+            if (m_pageFrames[page] <= buffer.frame)
+               continue;
+
+            size_t end = std::min((page + 1) * PAGE_SIZE, size);
+            for (size_t i = page * PAGE_SIZE; i < end; ++i)
+            {
+               Entity oldEntity = buffer.entities[i];
+               if (i < buffer.size && buffer.indices[oldEntity] == i)
+                  buffer.indices[oldEntity] = NULL_INDEX;
+
+               Entity entity = m_live.GetEntityAtIndex(i);
+               if (entity >= buffer.indices.size())
+                  buffer.indices.resize(size_t(entity) + 1, NULL_INDEX);
+
+               buffer.entities[i] = entity;
+               buffer.components[i] = m_live.GetByIndex(i);
+               buffer.indices[entity] = i;
+            }
+         }
+
+         buffer.size = size;
+         buffer.frame = m_frame;
+      }
+
+      PackedArray<Entity, Comp> m_live;
+      std::vector<uint64_t> m_pageFrames; // Frame of the last write to each page of the dense range
+      uint64_t m_frame = 1; // Frame currently being written, a buffer published at frame F holds every write up to F
+
+      std::array<Buffer, 2> m_buffers;
+      std::atomic<size_t> m_front = 0;
+      mutable std::array<std::atomic<uint32_t>, 2> m_readers = {};
+   };
+}
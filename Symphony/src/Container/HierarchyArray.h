@@ -0,0 +1,270 @@
+#pragma once
+
+#include "../Common.h"
+#include "PackedArray.h"
+#include "../Util/Parallel.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace Symphony
+{
+   // Stores a forest of entities in level order: every root comes first, then every node of depth 1, and so on. A parent
+   // therefore always sits at a lower dense index than its children, which turns propagation down the hierarchy into a
+   // single forward pass over a flat array of parent indices, and each level is a contiguous range that can be processed
+   // in parallel once the level above it is done.
+   //
+   // Structural changes keep the order incrementally by swapping elements across level boundaries through PackedArray's
+   // swap, at a cost of one swap per level below the affected node.
+   template<typename Entity, Component Comp>
+   class HierarchyArray
+   {
+      struct Link
+      {
+         Entity parent = NULL_ENTITY;
+         Entity firstChild = NULL_ENTITY;
+         Entity nextSibling = NULL_ENTITY;
+         Entity prevSibling = NULL_ENTITY;
+         size_t depth = 0;
+      };
+
+   public:
+      static constexpr size_t NULL_INDEX = ~size_t(0);
+
+      bool Add(Entity entity, const Comp& component, Entity parent = NULL_ENTITY)
+      {
+         if (m_array.Contains(entity))
+            return false;
+         if (parent != NULL_ENTITY && !m_array.Contains(parent))
+            return false;
+
+         size_t depth = parent != NULL_ENTITY ? m_links[m_array.GetIndex(parent)].depth + 1 : 0;
+
+         m_array.Add(entity, component);
+         m_links.push_back({ NULL_ENTITY, NULL_ENTITY, NULL_ENTITY, NULL_ENTITY, depth });
+         m_parentIndices.push_back(NULL_INDEX);
+         InsertIntoLevel(depth);
+
+         if (parent != NULL_ENTITY)
+            Attach(entity, parent);
+         return true;
+      }
+
+      // Removes entity together with its whole subtree
+      void Remove(Entity entity)
+      {
+         if (!m_array.Contains(entity))
+            return;
+
+         // Deepest first, so every node is a leaf by the time it is removed
+         std::vector<Entity> subtree = CollectSubtree(entity);
+         for (auto it = subtree.rbegin(); it != subtree.rend(); ++it)
+         {
+            Detach(*it);
+            size_t index = m_array.GetIndex(*it);
+            RemoveFromLevel(index, m_links[index].depth);
+
+            m_array.Remove(*it);
+            m_links.pop_back();
+            m_parentIndices.pop_back();
+         }
+      }
+
+      // Moves entity and its subtree under newParent, or makes it a root for NULL_ENTITY. Fails if newParent is not
+      // stored or lies inside entity's own subtree.
+      bool SetParent(Entity entity, Entity newParent)
+      {
+         if (!m_array.Contains(entity))
+            return false;
+         if (newParent != NULL_ENTITY)
+         {
+            if (!m_array.Contains(newParent))
+               return false;
+
+            for (Entity ancestor = newParent; ancestor != NULL_ENTITY; ancestor = m_links[m_array.GetIndex(ancestor)].parent)
+            {
+               if (ancestor == entity)
+                  return false;
+            }
+         }
+
+         Detach(entity);
+         if (newParent != NULL_ENTITY)
+            Attach(entity, newParent);
+
+         size_t newDepth = newParent != NULL_ENTITY ? m_links[m_array.GetIndex(newParent)].depth + 1 : 0;
+         if (newDepth == m_links[m_array.GetIndex(entity)].depth)
+            return true;
+
+         // Parents before children, so each node's new depth can be read off its already moved parent
+         for (Entity node : CollectSubtree(entity))
+         {
+            size_t index = m_array.GetIndex(node);
+            Entity parent = m_links[index].parent;
+            size_t depth = parent != NULL_ENTITY ? m_links[m_array.GetIndex(parent)].depth + 1 : 0;
+
+            RemoveFromLevel(index, m_links[index].depth);
+            m_links.back().depth = depth;
+            InsertIntoLevel(depth);
+         }
+         return true;
+      }
+
+      // Calls func(component, parentComponent) for every non-root node, parents strictly before their children
+      template<typename Func>
+      void Propagate(Func&& func)
+      {
+         for (size_t i = LevelCount() > 1 ? m_levelStarts[1] : Size(); i < Size(); ++i)
+            func(m_array.GetByIndex(i), m_array.GetByIndex(m_parentIndices[i]));
+      }
+
+      // Like Propagate, each level is split into cache line aligned chunks and finished before the next one starts
+      template<typename Func>
+      void ParallelPropagate(Func&& func, ThreadPool& pool = ThreadPool::Shared())
+      {
+         for (size_t level = 1; level < LevelCount(); ++level)
+         {
+            auto [begin, end] = LevelRange(level);
+            ParallelFor(pool, begin, end, CacheLineGranularity(sizeof(Comp)), [&](size_t chunkBegin, size_t chunkEnd, size_t)
+            {
+               for (size_t i = chunkBegin; i < chunkEnd; ++i)
+                  func(m_array.GetByIndex(i), m_array.GetByIndex(m_parentIndices[i]));
+            });
+         }
+      }
+
+      size_t LevelCount() const { return m_levelStarts.size() - 1; }
+
+      // Dense index range [first, second) holding every node of the given depth
+      std::pair<size_t, size_t> LevelRange(size_t level) const
+      {
+         assert(level < LevelCount() && "Level out of range");
+         return { m_levelStarts[level], m_levelStarts[level + 1] };
+      }
+
+      bool Contains(Entity entity) const { return m_array.Contains(entity); }
+
+      Comp& Get(Entity entity) { return m_array.Get(entity); }
+
+      Comp& GetByIndex(size_t index) { return m_array.GetByIndex(index); }
+
+      Entity GetEntityAtIndex(size_t index) { return m_array.GetEntityAtIndex(index); }
+
+      Entity GetParent(Entity entity) const { return m_array.Contains(entity) ? m_links[m_array.GetIndex(entity)].parent : NULL_ENTITY; }
+
+      size_t GetDepth(Entity entity) const { return m_array.Contains(entity) ? m_links[m_array.GetIndex(entity)].depth : NULL_INDEX; }
+
+      size_t GetParentIndex(size_t index) const { return m_parentIndices[index]; }
+
+      const std::vector<size_t>& GetParentIndices() const { return m_parentIndices; }
+
+      size_t Size() const { return m_array.Size(); }
+
+   private:
+      std::vector<Entity> CollectSubtree(Entity root)
+      {
+         std::vector<Entity> subtree = { root };
+         for (size_t i = 0; i < subtree.size(); ++i)
+         {
+            for (Entity child = m_links[m_array.GetIndex(subtree[i])].firstChild; child != NULL_ENTITY; child = m_links[m_array.GetIndex(child)].nextSibling)
+               subtree.push_back(child);
+         }
+         return subtree;
+      }
+
+      void Attach(Entity entity, Entity parent)
+      {
+         size_t index = m_array.GetIndex(entity);
+         size_t parentIndex = m_array.GetIndex(parent);
+         Link& link = m_links[index];
+         Link& parentLink = m_links[parentIndex];
+
+         link.parent = parent;
+         link.prevSibling = NULL_ENTITY;
+         link.nextSibling = parentLink.firstChild;
+         if (parentLink.firstChild != NULL_ENTITY)
+            m_links[m_array.GetIndex(parentLink.firstChild)].prevSibling = entity;
+         parentLink.firstChild = entity;
+
+         m_parentIndices[index] = parentIndex;
+      }
+
+      void Detach(Entity entity)
+      {
+         size_t index = m_array.GetIndex(entity);
+         Link& link = m_links[index];
+         if (link.parent == NULL_ENTITY)
+            return;
+
+         if (link.prevSibling != NULL_ENTITY)
+            m_links[m_array.GetIndex(link.prevSibling)].nextSibling = link.nextSibling;
+         else
+            m_links[m_array.GetIndex(link.parent)].firstChild = link.nextSibling;
+
+         if (link.nextSibling != NULL_ENTITY)
+            m_links[m_array.GetIndex(link.nextSibling)].prevSibling = link.prevSibling;
+
+         link.parent = NULL_ENTITY;
+         link.prevSibling = NULL_ENTITY;
+         link.nextSibling = NULL_ENTITY;
+         m_parentIndices[index] = NULL_INDEX;
+      }
+
+      // Exchanges two dense slots and repoints the children of both nodes at their new positions
+      void Swap(size_t indexA, size_t indexB)
+      {
+         if (indexA == indexB)
+            return;
+
+         m_array.Swap(indexA, indexB);
+         std::swap(m_links[indexA], m_links[indexB]);
+         std::swap(m_parentIndices[indexA], m_parentIndices[indexB]);
+
+         for (size_t index : { indexA, indexB })
+         {
+            for (Entity child = m_links[index].firstChild; child != NULL_ENTITY; child = m_links[m_array.GetIndex(child)].nextSibling)
+               m_parentIndices[m_array.GetIndex(child)] = index;
+         }
+      }
+
+      // The last element is not yet part of any level, rotate it into the end of depth by moving the first node of every
+      // deeper level to that level's end
+      void InsertIntoLevel(size_t depth)
+      {
+         assert(depth <= LevelCount() && "Level would leave a gap in the hierarchy");
+         if (depth == LevelCount())
+            m_levelStarts.push_back(m_levelStarts.back());
+
+         size_t index = m_levelStarts.back();
+         for (size_t level = LevelCount() - 1; level > depth; --level)
+         {
+            size_t first = m_levelStarts[level];
+            Swap(index, first);
+            index = first;
+            ++m_levelStarts[level];
+         }
+         ++m_levelStarts.back();
+      }
+
+      // Inverse of InsertIntoLevel, leaves the element at index as the last element, outside of every level
+      void RemoveFromLevel(size_t index, size_t depth)
+      {
+         for (size_t level = depth; level < LevelCount(); ++level)
+         {
+            size_t last = m_levelStarts[level + 1] - 1;
+            Swap(index, last);
+            index = last;
+            --m_levelStarts[level + 1];
+         }
+
+         while (LevelCount() > 0 && m_levelStarts[LevelCount() - 1] == m_levelStarts[LevelCount()])
+            m_levelStarts.pop_back();
+      }
+
+      PackedArray<Entity, Comp> m_array;
+      std::vector<Link> m_links;
+      std::vector<size_t> m_parentIndices;
+      std::vector<size_t> m_levelStarts = { 0 };
+   };
+}
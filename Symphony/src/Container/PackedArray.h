@@ -3,6 +3,7 @@
 #include "../Common.h"
 #include "SparseSet.h"
 #include "DenseArray.h"
+#include "../Util/AlignedAllocator.h"
 
 namespace Symphony
 {
@@ -10,6 +11,10 @@ namespace Symphony
    class PackedArray
    {
    public:
+      using ComponentType = Comp;
+
+      static constexpr size_t NULL_INDEX = SparseSet<Entity, size_t>::InvalidValue;
+
       void Add(Entity entity, const Comp& component)
       {
          if (m_sparseSet.Contains(entity))
@@ -17,19 +22,21 @@ namespace Symphony
 
          auto index = m_denseArray.Size();
          m_sparseSet.Insert(entity, index);
-         m_denseArray.Add(index, component);
+         m_denseArray.Add(entity, component);
       }
 
       void Remove(Entity entity) {
-         size_t index = m_sparseSet[entity];
-         if (!index)
+         size_t index = m_sparseSet.Get(entity);
+         if (index == SparseSet<Entity, size_t>::InvalidValue)
             return;
 
-         m_denseArray.Remove(index);
+         Entity lastEntity = m_denseArray.GetKeyAtIndex(m_denseArray.Size() - 1);
 
-         if (index < m_denseArray.Size())
+         // DenseArray swaps the last element into the vacated slot, mirror that in the sparse set
+         m_denseArray.Remove(entity);
+
+         if (lastEntity != entity)
          {
-            Entity lastEntity = m_denseArray.GetKeyAtIndex(m_denseArray.Size() - 1);
             m_sparseSet.Remove(lastEntity);
             m_sparseSet.Insert(lastEntity, index);
          }
@@ -37,10 +44,26 @@ namespace Symphony
          m_sparseSet.Remove(entity);
       }
 
+      // Exchanges the dense slots of two elements, entities keep their components
+      void Swap(size_t indexA, size_t indexB)
+      {
+         if (indexA == indexB)
+            return;
+
+         m_denseArray.Swap(indexA, indexB);
+
+         Entity entityA = m_denseArray.GetKeyAtIndex(indexA);
+         Entity entityB = m_denseArray.GetKeyAtIndex(indexB);
+         m_sparseSet.Remove(entityA);
+         m_sparseSet.Remove(entityB);
+         m_sparseSet.Insert(entityA, indexA);
+         m_sparseSet.Insert(entityB, indexB);
+      }
+
       Comp& Get(Entity entity)
       {
-         auto index = m_sparseSet[entity];
-         if (!index)
+         size_t index = m_sparseSet.Get(entity);
+         if (index == SparseSet<Entity, size_t>::InvalidValue)
          {
             static Comp dummy;
             return dummy;
@@ -49,10 +72,19 @@ namespace Symphony
          return m_denseArray.GetByIndex(index);
       }
 
+      bool Contains(Entity entity) const { return m_sparseSet.Contains(entity); }
+
+      // Returns NULL_INDEX if entity is not stored
+      size_t GetIndex(Entity entity) const { return m_sparseSet[entity]; }
+
+      Comp& GetByIndex(size_t index) { return m_denseArray.GetByIndex(index); }
+
+      Entity GetEntityAtIndex(size_t index) { return m_denseArray.GetKeyAtIndex(index); }
+
       size_t Size() const { return m_denseArray.Size(); }
 
    private:
       SparseSet<Entity, size_t> m_sparseSet;
-      DenseArray<size_t, Comp> m_denseArray;
+      DenseArray<Entity, Comp, AlignedAllocator<Comp>> m_denseArray;
    };
-}
\ No newline at end of file
+}
@@ -5,18 +5,18 @@
 #include "../Common.h"
 
 #include <algorithm>
-#include <array>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <new>
 #include <optional>
 #include <type_traits>
 #include <utility>
 
 namespace Symphony
 {
-   class Bucket;
-
-   template<typename Key = Entity, typename Value = size_t, typename KeyAlloc = std::allocator<Key>, typename BucketAlloc = std::allocator<Bucket>>
+   template<typename Key = Entity, typename Value = size_t, typename KeyAlloc = std::allocator<Key>, typename BucketAlloc = std::allocator<std::byte>>
    requires Allocator<KeyAlloc> && Allocator<BucketAlloc>
    class SparseSet
    {
@@ -26,160 +26,90 @@ namespace Symphony
       static constexpr size_t SPARSE_BUCKET_SHIFT = 10;
       static constexpr size_t SPARSE_BUCKET_SIZE = 1 << SPARSE_BUCKET_SHIFT;
 
+      // Sorted offsets of the keys that fall into one bucket, each paired with the key's position in the dense arrays
       class Bucket
       {
       public:
          Bucket() : m_size(0)
          {
-            size_t alignment = std::max(alignof(Key), alignof(Value));
-            
-            m_data = static_cast<char*>(_aligned_malloc(SPARSE_BUCKET_SIZE * (sizeof(Key) + sizeof(Value)), alignment));
-            m_keys = reinterpret_cast<Key*>(m_data);
-            m_values = reinterpret_cast<Value*>(m_data + SPARSE_BUCKET_SIZE * sizeof(Key));
+            m_data = static_cast<char*>(::operator new(SPARSE_BUCKET_SIZE * (sizeof(size_t) + sizeof(size_t)), std::align_val_t(alignof(size_t))));
+            m_offsets = reinterpret_cast<size_t*>(m_data);
+            m_positions = reinterpret_cast<size_t*>(m_data + SPARSE_BUCKET_SIZE * sizeof(size_t));
          }
 
          ~Bucket()
          {
-            _aligned_free(m_data);
-            m_keys = nullptr;
-            m_values = nullptr;
+            ::operator delete(m_data, std::align_val_t(alignof(size_t)));
+            m_offsets = nullptr;
+            m_positions = nullptr;
          }
 
-         inline void Deallocate(BucketAlloc* allocator)
-         {
-            if (m_keys || m_values) [[unlikely]]
-               return;
-
-            if (allocator) [[likely]]
-               allocator->deallocate(this);
-         }
-
-         void* operator new(size_t size, BucketAlloc& pool) { return pool.allocate(size); }
-
-         void operator delete(void* p, BucketAlloc& pool) { pool.deallocate(p); }
+         Bucket(const Bucket&) = delete;
+         Bucket& operator=(const Bucket&) = delete;
 
-         inline bool Contains(Key key) const { return std::binary_search(m_keys, m_keys + m_size, key); }
+         inline bool Contains(size_t offset) const { return std::binary_search(m_offsets, m_offsets + m_size, offset); }
 
-         [[nodiscard]] inline std::optional<Value> Value(Key key) const
+         [[nodiscard]] inline std::optional<size_t> Position(size_t offset) const
          {
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (it && (it != m_keys + m_size && *it == key))
-               return m_values[std::distance(m_keys, it)];
+            auto it = std::lower_bound(m_offsets, m_offsets + m_size, offset);
+            if (it != m_offsets + m_size && *it == offset)
+               return m_positions[std::distance(m_offsets, it)];
             return std::nullopt;
          }
 
-         inline bool Insert(Key key, Value value)
+         inline bool Insert(size_t offset, size_t position)
          {
             if (m_size >= SPARSE_BUCKET_SIZE) [[unlikely]]
                return false;
 
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (!it)
-               return false;
-            auto index = std::distance(m_keys, it);
+            auto it = std::lower_bound(m_offsets, m_offsets + m_size, offset);
+            auto index = std::distance(m_offsets, it);
 
-            // Shift keys and values to make space for the new k/v pair
-            std::memmove(&m_keys[index + 1], &m_keys[index], (m_size - index) * sizeof(Key));
-            std::memmove(&m_values[index + 1], &m_values[index], (m_size - index) * sizeof(Value));
+            // Shift offsets and positions to make space for the new pair
+            std::memmove(&m_offsets[index + 1], &m_offsets[index], (m_size - index) * sizeof(size_t));
+            std::memmove(&m_positions[index + 1], &m_positions[index], (m_size - index) * sizeof(size_t));
 
-            m_keys[index] = key;
-            m_values[index] = value;
+            m_offsets[index] = offset;
+            m_positions[index] = position;
             ++m_size;
             return true;
          }
 
-         inline void Remove(Key key)
+         inline void SetPosition(size_t offset, size_t position)
          {
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (!it || it == m_keys + m_size || *it != key)
-               return;
-
-            auto index = std::distance(m_keys, it);
-
-            // Shift keys and values to cover up the gap left by the removed k/v pair
-            std::memmove(&m_keys[index], &m_keys[index + 1], (m_size - index - 1) * sizeof(Key));
-            std::memmove(&m_values[index], &m_values[index + 1], (m_size - index - 1) * sizeof(Value));
-
-            --m_size;
+            auto it = std::lower_bound(m_offsets, m_offsets + m_size, offset);
+            if (it != m_offsets + m_size && *it == offset)
+               m_positions[std::distance(m_offsets, it)] = position;
          }
 
-         void Distribute(Bucket& other)
+         inline void Remove(size_t offset)
          {
-            if (other == *this)
+            auto it = std::lower_bound(m_offsets, m_offsets + m_size, offset);
+            if (it == m_offsets + m_size || *it != offset)
                return;
 
-            size_t mid = m_size >> 1;
+            auto index = std::distance(m_offsets, it);
 
-            // Move the latter half of this bucket's keys & values to the beginning of other
-            std::move(m_keys + mid, m_keys + m_size, other.m_keys);
-            std::move(m_values + mid, m_values + m_size, other.m_values);
+            // Shift offsets and positions to cover up the gap left by the removed pair
+            std::memmove(&m_offsets[index], &m_offsets[index + 1], (m_size - index - 1) * sizeof(size_t));
+            std::memmove(&m_positions[index], &m_positions[index + 1], (m_size - index - 1) * sizeof(size_t));
 
-            other.m_size = m_size - mid;
-            m_size = mid;
-         }
-
-         void Merge(Bucket& other)
-         {
-            if (other == *this)
-               return;
-
-            // Move all keys & values from other to the end of this bucket
-            std::move(other.m_keys, other.m_keys + other.m_size, m_keys + m_size);
-            std::move(other.m_values, other.m_values + other.m_size, m_values + m_size);
-            m_size += other.m_size;
-         }
-
-         void Rebalance(Bucket& other)
-         {
-            if (other == *this)
-               return;
-
-            size_t totalSize = m_size + other.m_size;
-            size_t targetSize = totalSize >> 1;
-            size_t entitiesToMove = 0;
-
-            if (m_size < targetSize)
-            {
-               // Move entities from other to this bucket
-               entitiesToMove = targetSize - m_size;
-
-               // Move entities from the beginning of other to the end of this bucket
-               std::move(other.m_keys, other.m_keys + entitiesToMove, m_keys + m_size);
-               std::move(other.m_values, other.m_values + entitiesToMove, m_values + m_size);
-
-               // Shift the entities in other to fill the gap
-               std::move(other.m_keys + entitiesToMove, other.m_keys + other.m_size, other.m_keys);
-               std::move(other.m_values + entitiesToMove, other.m_values + other.m_size, other.m_values);
-            }
-            else
-            {
-               // Move entities from this bucket to other
-               entitiesToMove = m_size - targetSize;
-
-               // Shift the entities in other to make room for incoming entities
-               std::move_backward(other.m_keys, other.m_keys + other.m_size, other.m_keys + other.m_size + entitiesToMove);
-               std::move_backward(other.m_values, other.m_values + other.m_size, other.m_values + other.m_size + entitiesToMove);
-
-               // Move entities from the end of this bucket to the beginning of other
-               std::move(m_keys + targetSize, m_keys + m_size, other.m_keys);
-               std::move(m_values + targetSize, m_values + m_size, other.m_values);
-            }
-
-            m_size = targetSize;
-            other.m_size = totalSize - targetSize;
+            --m_size;
          }
 
          inline size_t Size() const { return m_size; }
 
       private:
          char* m_data;
-         Key* m_keys;
-         Value* m_values;
+         size_t* m_offsets;
+         size_t* m_positions;
          size_t m_size;
       };
 
-      using EntityAllocatorType = std::allocator_traits<KeyAlloc>::template rebind_alloc<Key>;
-      using BucketAllocatorType = std::allocator_traits<BucketAlloc>::template rebind_alloc<Bucket>;
+      using EntityAllocatorType = typename std::allocator_traits<KeyAlloc>::template rebind_alloc<Key>;
+      using ValueAllocatorType = typename std::allocator_traits<KeyAlloc>::template rebind_alloc<Value>;
+      using BucketAllocatorType = typename std::allocator_traits<BucketAlloc>::template rebind_alloc<Bucket>;
+      using BucketAllocatorTraits = std::allocator_traits<BucketAllocatorType>;
 
    public:
       class Iterator
@@ -271,132 +201,91 @@ namespace Symphony
 
       using ConstIterator = const Iterator;
 
-      using InvalidValue = std::numeric_limits<Value>::value;
+      static constexpr Value InvalidValue = std::numeric_limits<Value>::max();
 
       explicit SparseSet(size_t initialCapacity = SPARSE_BUCKET_SIZE, float growFactor = 2) :
          m_entityAllocator(KeyAlloc()),
-         m_bucketAllocator(BucketAlloc),
+         m_valueAllocator(KeyAlloc()),
+         m_bucketAllocator(BucketAlloc()),
          m_size(0),
-         m_capacity(initialCapacity),
-         m_growFactor(growFactor)
+         m_capacity(std::max<size_t>(initialCapacity, 1)),
+         m_growFactor(std::max(growFactor, 1.5f))
       {
          m_dense = m_entityAllocator.allocate(m_capacity);
+         m_values = m_valueAllocator.allocate(m_capacity);
       }
 
       ~SparseSet()
       {
-         for (auto& [_, bucket] : m_sparse)
-         {
-            if (bucket)
-            {
-               bucket->~Bucket();
-               bucket->Deallocate(&m_bucketAllocator);
-            }
-         }
-         m_sparse.clear();
+         Clear();
          m_entityAllocator.deallocate(m_dense, m_capacity);
+         m_valueAllocator.deallocate(m_values, m_capacity);
       }
 
+      SparseSet(const SparseSet&) = delete;
+      SparseSet& operator=(const SparseSet&) = delete;
+
       Value operator[](Key key) { return Get(key); }
       const Value operator[](Key key) const { return Get(key); }
 
+      // Returns the key's position in the dense arrays, an already present key keeps its value
       size_t Insert(Key entity, Value value)
       {
          auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
          Bucket* bucket = GetOrCreateBucket(bucketIndex);
-         if (!bucket)
-            return m_size;
-         if (bucket->Contains(offset))
-            return bucket->Value(offset).value_or(-1);
-
-         // Create new bucket and distribute selected buckets elements
-         if (bucket->Size() >= SPARSE_BUCKET_SIZE)
-         {
-            Bucket* newBucket = GetOrCreateBucket(bucketIndex + 1);
-            if (newBucket)
-               bucket->Distribute(*newBucket);
-         }
+         if (auto position = bucket->Position(offset))
+            return *position;
 
          if (m_size == m_capacity)
-            Resize(m_capacity * m_growFactor);
+            Resize(static_cast<size_t>(m_capacity * m_growFactor) + 1);
 
          m_dense[m_size] = entity;
-         bucket->Insert(offset, value);
+         m_values[m_size] = value;
+         bucket->Insert(offset, m_size);
 
          return m_size++;
       }
 
-      [[nodiscard]] Value Get(Key entity)
+      [[nodiscard]] Value Get(Key entity) const
       {
          auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
          auto bucketIt = m_sparse.find(bucketIndex);
-         if (bucketIt && bucketIt != m_sparse.end())
-            return bucketIt->second->Value(offset);
-         return InvalidValue;
-      }
+         if (bucketIt == m_sparse.end())
+            return InvalidValue;
 
-      [[nodiscard]] const Value Get(Key entity) const
-      {
-         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         auto bucketIt = m_sparse.find(bucketIndex);
-         if (bucketIt && bucketIt != m_sparse.end())
-            return bucketIt->second->Value(offset);
-         return InvalidValue;
+         auto position = bucketIt->second->Position(offset);
+         return position ? m_values[*position] : InvalidValue;
       }
 
       void Remove(Key entity)
       {
          auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         Bucket* bucket = GetOrCreateBucket(bucketIndex);
-         if (!bucket)
+         auto bucketIt = m_sparse.find(bucketIndex);
+         if (bucketIt == m_sparse.end())
             return;
 
-         auto removedIndexOpt = bucket->Value(offset);
-         if (removedIndexOpt ==  std::nullopt)
+         Bucket* bucket = bucketIt->second;
+         auto removedPosition = bucket->Position(offset);
+         if (!removedPosition)
             return;
 
-         Value removedIndex = removedIndexOpt.value();
-
          // If target entity is not last in the dense array, swap it with the last entity to maintain dense packing
+         size_t removedIndex = *removedPosition;
          if (removedIndex != m_size - 1)
          {
             Key last = m_dense[m_size - 1];
             m_dense[removedIndex] = last;
+            m_values[removedIndex] = m_values[m_size - 1];
 
             auto [lastBucketIndex, lastOffset] = GetBucketIndexAndOffset(last);
-            Bucket* lastBucket = m_sparse[lastBucketIndex];
-            if (lastBucket)
-            {
-               lastBucket->Remove(lastOffset);
-               lastBucket->Insert(lastOffset, removedIndex);
-            }
+            m_sparse[lastBucketIndex]->SetPosition(lastOffset, removedIndex);
          }
 
          bucket->Remove(offset);
-
-         // If a bucket is underfilled, check if it should be merged or rebalanced with the next bucket
-         if (bucket->Size() < SPARSE_BUCKET_SIZE >> 1)
+         if (bucket->Size() == 0)
          {
-            auto nextBucketIter = m_sparse.find(bucketIndex + 1);
-            if (nextBucketIter && nextBucketIter != m_sparse.end())
-            {
-               Bucket* nextBucket = nextBucketIter->second;
-               if (nextBucket)
-               {
-                  // If the combined size of the current and next bucket is within limits, merge them
-                  if (bucket->Size() + nextBucket->Size() <= SPARSE_BUCKET_SIZE)
-                  {
-                     bucket->Merge(*nextBucket);
-                     nextBucket->~Bucket();
-                     nextBucket->Deallocate(m_bucketAllocator);
-                     m_sparse.erase(nextBucketIter);
-                  } // Otherwise, rebalance
-                  else
-                  {
-                     bucket->Rebalance(*nextBucket);
-                  }
-               }
-            }
+            DestroyBucket(bucket);
+            m_sparse.erase(bucketIt);
          }
          --m_size;
       }
@@ -405,20 +294,14 @@ namespace Symphony
       {
          auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
          auto bucketIt = m_sparse.find(bucketIndex);
-         
-         return bucketIt && bucketIt != m_sparse.end() && bucketIt->second->Contains(offset);
+
+         return bucketIt != m_sparse.end() && bucketIt->second->Contains(offset);
       }
 
       void Clear()
       {
          for (auto& [_, bucket] : m_sparse)
-         {
-            if (bucket)
-            {
-               bucket->~Bucket();
-               bucket->Deallocate(m_bucketAllocator);
-            }
-         }
+            DestroyBucket(bucket);
          m_sparse.clear();
          m_size = 0;
       }
@@ -427,22 +310,31 @@ namespace Symphony
 
       inline size_t Capacity() const { return m_capacity; }
 
-      Iterator begin() { return Iterator(m_dense, m_sparse); }
-      Iterator end() { return Iterator(m_dense + m_size, m_sparse + m_size); }
+      Iterator begin() { return Iterator(m_dense, m_values); }
+      Iterator end() { return Iterator(m_dense + m_size, m_values + m_size); }
 
-      ConstIterator cbegin() const { return Iterator(m_dense, m_sparse); }
-      ConstIterator cend() const { return Iterator(m_dense + m_size, m_sparse + m_size); }
+      ConstIterator cbegin() const { return Iterator(m_dense, m_values); }
+      ConstIterator cend() const { return Iterator(m_dense + m_size, m_values + m_size); }
 
    private:
       [[nodiscard]] Bucket* GetOrCreateBucket(size_t bucketIndex)
       {
          auto [it, created] = m_sparse.try_emplace(bucketIndex, nullptr);
          if (created)
-            it->second = new(m_bucketAllocator) Bucket();
+         {
+            it->second = BucketAllocatorTraits::allocate(m_bucketAllocator, 1);
+            BucketAllocatorTraits::construct(m_bucketAllocator, it->second);
+         }
          return it->second;
       }
 
-      [[nodiscard]] inline std::pair<size_t, size_t> GetBucketIndexAndOffset(Key entity) const { return { entity >> SPARSE_BUCKET_SHIFT, entity & (SPARSE_BUCKET_SIZE - 1) }; }
+      void DestroyBucket(Bucket* bucket)
+      {
+         BucketAllocatorTraits::destroy(m_bucketAllocator, bucket);
+         BucketAllocatorTraits::deallocate(m_bucketAllocator, bucket, 1);
+      }
+
+      [[nodiscard]] inline std::pair<size_t, size_t> GetBucketIndexAndOffset(Key entity) const { return { size_t(entity) >> SPARSE_BUCKET_SHIFT, size_t(entity) & (SPARSE_BUCKET_SIZE - 1) }; }
 
       inline void Resize(size_t newCapacity)
       {
@@ -450,20 +342,24 @@ namespace Symphony
             return;
 
          Key* newDense = m_entityAllocator.allocate(newCapacity);
-         if (!newDense)
-            return;
+         Value* newValues = m_valueAllocator.allocate(newCapacity);
 
          std::move(m_dense, m_dense + m_size, newDense);
+         std::move(m_values, m_values + m_size, newValues);
          m_entityAllocator.deallocate(m_dense, m_capacity);
+         m_valueAllocator.deallocate(m_values, m_capacity);
          m_dense = newDense;
+         m_values = newValues;
          m_capacity = newCapacity;
       }
 
       EntityAllocatorType m_entityAllocator;
+      ValueAllocatorType m_valueAllocator;
       BucketAllocatorType m_bucketAllocator;
 
       Key* m_dense;
-      std::map<Value, Bucket*> m_sparse;
+      Value* m_values;
+      std::map<size_t, Bucket*> m_sparse;
       size_t m_size;
       size_t m_capacity;
       float m_growFactor;
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "../Common.h"
+#include "../Container/PackedArray.h"
+#include "../Util/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace Symphony
+{
+   // Empty payload, a query's PackedArray only exists for its packed entity order
+   struct QueryMatch {};
+
+   // Cost of each operation counted by QueryStats, relative to one signature check. They depend on the machine and on
+   // how scattered the pools are, so pass measured values where the answer matters. QueryCostBenchmark in SymphonyTests
+   // (run with --bench) measures them, the defaults are rounded results of one -O2 run over 2^16 entities in random
+   // order (g++ 12, x86-64).
+   struct QueryCosts
+   {
+      double signatureCheck = 1.0;
+      double probe = 110.0;              // One PackedArray lookup by entity (a SparseSet::Get)
+      double membershipChange = 380.0;   // One PackedArray<Entity, QueryMatch> Add or Remove
+   };
+
+   // Raw counters for deciding whether a persistent query earns its upkeep compared with an equivalent View
+   struct QueryStats
+   {
+      size_t signatureChecks = 0;          // Made by Add of one of the query's components and when the query is built
+      size_t probes = 0;                   // Match set lookups on Remove and pool moves, pool lookups on insert
+      size_t inserts = 0;
+      size_t removes = 0;
+      size_t iterations = 0;
+      size_t visited = 0;                  // Matches handed to ForEach callers
+      size_t signatureChecksAvoided = 0;   // Candidates an equivalent View would have checked
+      size_t probesAvoided = 0;            // Component lookups an equivalent View would have made for the visited matches
+
+      [[nodiscard]] double MaintenanceCost(const QueryCosts& costs = {}) const
+      {
+         return costs.signatureCheck * double(signatureChecks) + costs.probe * double(probes) + costs.membershipChange * double(inserts + removes);
+      }
+
+      [[nodiscard]] double IterationSavings(const QueryCosts& costs = {}) const
+      {
+         return costs.signatureCheck * double(signatureChecksAvoided) + costs.probe * double(probesAvoided);
+      }
+
+      // Positive once the query has saved more than it cost to maintain, in units of one signature check
+      [[nodiscard]] double EstimatedSavings(const QueryCosts& costs = {}) const { return IterationSavings(costs) - MaintenanceCost(costs); }
+
+      [[nodiscard]] bool PaysOff(const QueryCosts& costs = {}) const { return EstimatedSavings(costs) > 0.0; }
+   };
+
+   // Matching entity set of one signature mask, owned by the registry and updated as components come and go. Next to
+   // each match it stores the match's dense index in every pool of the mask, in pool index order, so iteration reads
+   // components by index instead of looking the entity up in each pool.
+   template<typename Signature>
+   class QueryStorage
+   {
+   public:
+      explicit QueryStorage(Signature mask) :
+         m_mask(mask),
+         m_stride(std::popcount(mask))
+      {}
+
+      // Position of the pool with the given index inside each match's block of dense indices
+      [[nodiscard]] static constexpr size_t Slot(Signature mask, size_t poolIndex)
+      {
+         return std::popcount(mask & ((Signature(1) << poolIndex) - 1));
+      }
+
+      // Called after a component in the mask was added, signature already contains it. denseIndexOf(poolIndex) returns
+      // entity's dense index in that pool.
+      template<typename DenseIndexOf>
+      void OnAdd(Entity entity, Signature signature, DenseIndexOf&& denseIndexOf)
+      {
+         ++m_stats.signatureChecks;
+         if ((signature & m_mask) != m_mask || m_matches.Contains(entity))
+            return;
+
+         m_matches.Add(entity, QueryMatch());
+         for (Signature bits = m_mask; bits != 0; bits &= bits - 1)
+            m_denseIndices.push_back(denseIndexOf(size_t(std::countr_zero(bits))));
+
+         ++m_stats.inserts;
+         m_stats.probes += m_stride;
+      }
+
+      // Called before a component in the mask is removed
+      void OnRemove(Entity entity)
+      {
+         ++m_stats.probes;
+         size_t match = m_matches.GetIndex(entity);
+         if (match == PackedArray<Entity, QueryMatch>::NULL_INDEX)
+            return;
+
+         // PackedArray moves the last match into the vacated slot, its dense indices follow it
+         size_t last = m_matches.Size() - 1;
+         if (match != last)
+            std::copy_n(m_denseIndices.begin() + last * m_stride, m_stride, m_denseIndices.begin() + match * m_stride);
+         m_denseIndices.resize(last * m_stride);
+
+         m_matches.Remove(entity);
+         ++m_stats.removes;
+      }
+
+      // Called when the pool at poolIndex, which is in the mask, moves entity to another dense index
+      void OnMove(Entity entity, size_t poolIndex, size_t denseIndex)
+      {
+         ++m_stats.probes;
+         size_t match = m_matches.GetIndex(entity);
+         if (match != PackedArray<Entity, QueryMatch>::NULL_INDEX)
+            m_denseIndices[match * m_stride + Slot(m_mask, poolIndex)] = denseIndex;
+      }
+
+      Signature Mask() const { return m_mask; }
+
+      PackedArray<Entity, QueryMatch>& Matches() { return m_matches; }
+
+      size_t DenseIndex(size_t match, size_t slot) const { return m_denseIndices[match * m_stride + slot]; }
+
+      QueryStats& Stats() { return m_stats; }
+
+   private:
+      Signature m_mask;
+      size_t m_stride;
+      PackedArray<Entity, QueryMatch> m_matches;
+      std::vector<size_t> m_denseIndices;
+      QueryStats m_stats;
+   };
+
+   // Handle to a persistent query. Iteration is a linear scan over the cached matches: membership is never
+   // re-evaluated and components are read through the stored dense indices, with no lookups in the pools.
+   template<typename RegistryType, Component... Ts>
+   class Query
+   {
+      static_assert(sizeof...(Ts) > 0, "Query: At least one component type is required.");
+
+      using Storage = QueryStorage<typename RegistryType::Signature>;
+
+      template<Component T>
+      static constexpr size_t SLOT = Storage::Slot(RegistryType::template SIGNATURE<Ts...>, RegistryType::template POOL_INDEX<T>);
+
+   public:
+      Query(RegistryType& registry, Storage& storage) :
+         m_registry(registry),
+         m_storage(storage)
+      {}
+
+      template<typename Func>
+      void ForEach(Func&& func)
+      {
+         auto& matches = m_storage.Matches();
+         RecordIteration(matches.Size());
+
+         // Iterate backwards so func may remove the current entity's components without skipping any
+         for (size_t i = matches.Size(); i-- > 0;)
+            func(matches.GetEntityAtIndex(i), m_registry.template GetPool<Ts>().GetByIndex(m_storage.DenseIndex(i, SLOT<Ts>))...);
+      }
+
+      // Splits the cached matches into chunks and runs func(entity, components...) on the pool's threads. Chunks are cache
+      // line aligned for the match array only, the components sit at scattered dense indices of their pools and may
+      // share lines across threads. No pool and no query sharing a component with this one may be structurally
+      // modified until the call returns.
+      template<typename Func>
+      void ParallelForEach(Func&& func, ThreadPool& pool = ThreadPool::Shared())
+      {
+         auto& matches = m_storage.Matches();
+         RecordIteration(matches.Size());
+
+         ParallelFor(pool, matches.Size(), CacheLineGranularity(sizeof(Entity)), [&](size_t begin, size_t end, size_t)
+         {
+            for (size_t i = begin; i < end; ++i)
+               func(matches.GetEntityAtIndex(i), m_registry.template GetPool<Ts>().GetByIndex(m_storage.DenseIndex(i, SLOT<Ts>))...);
+         });
+      }
+
+      size_t Size() const { return m_storage.Matches().Size(); }
+
+      const QueryStats& GetStats() const { return m_storage.Stats(); }
+
+   private:
+      // A View over Ts checks the signature of every entity in its smallest pool and looks every match up in each pool
+      void RecordIteration(size_t matchCount)
+      {
+         std::array<size_t, sizeof...(Ts)> sizes = { m_registry.template GetPool<Ts>().Size()... };
+
+         QueryStats& stats = m_storage.Stats();
+         ++stats.iterations;
+         stats.visited += matchCount;
+         stats.signatureChecksAvoided += *std::min_element(sizes.begin(), sizes.end());
+         stats.probesAvoided += matchCount * sizeof...(Ts);
+      }
+
+      RegistryType& m_registry;
+      Storage& m_storage;
+   };
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "../Common.h"
+#include "../Container/PackedArray.h"
+#include "../Util/TypeInfo.h"
+#include "Query.h"
+#include "View.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace Symphony
+{
+   template<typename ComponentList>
+   class BasicRegistry;
+
+   // A registry over a closed set of component types. Each type's pool lives at a fixed position in a tuple, so pool
+   // lookup for a known type is a constant index resolved by the compiler rather than a hash map probe.
+   template<Component... Components>
+   class BasicRegistry<TypeList<Components...>>
+   {
+      static_assert(sizeof...(Components) > 0, "Registry: At least one component type is required.");
+      static_assert(sizeof...(Components) <= 64, "Registry: Signatures are limited to 64 component types.");
+      static_assert(UniqueTypes<Components...>, "Registry: Component types must be unique.");
+      static_assert(UniqueComponentIDs<Components...>, "Registry: Component ID collision, rename one of the types.");
+
+   public:
+      using Signature = uint64_t;
+
+      template<Component T>
+      using Pool = PackedArray<Entity, T>;
+
+      static constexpr size_t COMPONENT_COUNT = sizeof...(Components);
+
+      template<Component T>
+      static constexpr size_t POOL_INDEX = IndexOfType<T, Components...>;
+
+      template<Component... Ts>
+      static constexpr Signature SIGNATURE = ((Signature(1) << POOL_INDEX<Ts>) | ... | Signature(0));
+
+      // Maps a runtime ComponentID back to its pool index, returns COMPONENT_COUNT for unknown IDs
+      [[nodiscard]] static constexpr size_t PoolIndex(ComponentID id)
+      {
+         auto it = std::lower_bound(SORTED_IDS.begin(), SORTED_IDS.end(), id, [](const auto& entry, ComponentID value) { return entry.first < value; });
+         if (it != SORTED_IDS.end() && it->first == id)
+            return it->second;
+         return COMPONENT_COUNT;
+      }
+
+      Entity Create()
+      {
+         if (!m_freeEntities.empty())
+         {
+            Entity entity = m_freeEntities.back();
+            m_freeEntities.pop_back();
+            m_alive[entity] = true;
+            return entity;
+         }
+
+         Entity entity = static_cast<Entity>(m_signatures.size());
+         m_signatures.push_back(0);
+         m_alive.push_back(true);
+         return entity;
+      }
+
+      void Destroy(Entity entity)
+      {
+         if (!Valid(entity))
+            return;
+
+         (RemoveIfPresent<Components>(entity), ...);
+         m_signatures[entity] = 0;
+         m_alive[entity] = false;
+         m_freeEntities.push_back(entity);
+      }
+
+      [[nodiscard]] bool Valid(Entity entity) const { return entity < m_alive.size() && m_alive[entity]; }
+
+      template<Component T>
+      T& Add(Entity entity, const T& component = T())
+      {
+         assert(Valid(entity) && "Entity is not alive in Registry");
+         auto& pool = GetPool<T>();
+         pool.Add(entity, component);
+         m_signatures[entity] |= SIGNATURE<T>;
+
+         for (auto* query : m_queriesByComponent[POOL_INDEX<T>])
+            query->OnAdd(entity, m_signatures[entity], [&](size_t poolIndex) { return DenseIndex(poolIndex, entity); });
+
+         return pool.Get(entity);
+      }
+
+      template<Component T>
+      void Remove(Entity entity)
+      {
+         if (!Valid(entity))
+            return;
+
+         RemoveIfPresent<T>(entity);
+      }
+
+      template<Component T>
+      T& Get(Entity entity) { return GetPool<T>().Get(entity); }
+
+      template<Component... Ts>
+      [[nodiscard]] bool Has(Entity entity) const
+      {
+         constexpr Signature mask = SIGNATURE<Ts...>;
+         return Valid(entity) && (m_signatures[entity] & mask) == mask;
+      }
+
+      [[nodiscard]] Signature GetSignature(Entity entity) const { return Valid(entity) ? m_signatures[entity] : 0; }
+
+      template<Component T>
+      Pool<T>& GetPool() { return std::get<POOL_INDEX<T>>(m_pools); }
+
+      template<Component... Ts>
+      View<BasicRegistry, Ts...> GetView() { return View<BasicRegistry, Ts...>(*this, GetPool<Ts>()...); }
+
+      // Returns a persistent query over Ts. The first request builds the matching set, after that the registry keeps it
+      // and each match's dense index in every pool of Ts up to date on every Add and Remove of one of Ts. Later requests
+      // for the same component set share it. Pools must only be structurally modified through the registry.
+      template<Component... Ts>
+      Query<BasicRegistry, Ts...> GetQuery()
+      {
+         constexpr Signature mask = SIGNATURE<Ts...>;
+         for (auto& storage : m_queries)
+         {
+            if (storage->Mask() == mask)
+               return Query<BasicRegistry, Ts...>(*this, *storage);
+         }
+
+         auto& storage = *m_queries.emplace_back(std::make_unique<QueryStorage<Signature>>(mask));
+         (m_queriesByComponent[POOL_INDEX<Ts>].push_back(&storage), ...);
+
+         for (Entity entity = 0; entity < m_signatures.size(); ++entity)
+            storage.OnAdd(entity, m_signatures[entity], [&](size_t poolIndex) { return DenseIndex(poolIndex, entity); });
+
+         return Query<BasicRegistry, Ts...>(*this, storage);
+      }
+
+      size_t Size() const { return m_signatures.size() - m_freeEntities.size(); }
+
+   private:
+      static constexpr std::array<std::pair<ComponentID, size_t>, COMPONENT_COUNT> SORTED_IDS = []
+      {
+         std::array<std::pair<ComponentID, size_t>, COMPONENT_COUNT> ids = { std::pair<ComponentID, size_t>(ComponentTypeIDValue<Components>, POOL_INDEX<Components>)... };
+         std::sort(ids.begin(), ids.end());
+         return ids;
+      }();
+
+      template<Component T>
+      void RemoveIfPresent(Entity entity)
+      {
+         if (!(m_signatures[entity] & SIGNATURE<T>))
+            return;
+
+         // The pool fills the vacated slot with its last element, queries that store dense indices into it must follow
+         auto& pool = GetPool<T>();
+         size_t index = pool.GetIndex(entity);
+         Entity moved = pool.GetEntityAtIndex(pool.Size() - 1);
+         for (auto* query : m_queriesByComponent[POOL_INDEX<T>])
+         {
+            query->OnRemove(entity);
+            if (moved != entity)
+               query->OnMove(moved, POOL_INDEX<T>, index);
+         }
+
+         pool.Remove(entity);
+         m_signatures[entity] &= ~SIGNATURE<T>;
+      }
+
+      // Dense index of entity in the pool at poolIndex, entity must have that component
+      size_t DenseIndex(size_t poolIndex, Entity entity)
+      {
+         size_t index = 0;
+         ((POOL_INDEX<Components> == poolIndex ? void(index = GetPool<Components>().GetIndex(entity)) : void()), ...);
+         return index;
+      }
+
+      std::tuple<Pool<Components>...> m_pools;
+      std::vector<Signature> m_signatures;
+      std::vector<bool> m_alive;
+      std::vector<Entity> m_freeEntities;
+
+      std::vector<std::unique_ptr<QueryStorage<Signature>>> m_queries;
+      std::array<std::vector<QueryStorage<Signature>*>, COMPONENT_COUNT> m_queriesByComponent;
+   };
+
+   // Pools and signature bits follow declaration order
+   template<Component... Components>
+   using Registry = BasicRegistry<TypeList<Components...>>;
+
+   // Pools and signature bits follow ComponentID order, so the same component set produces the same signatures no
+   // matter how the registry was spelled
+   template<Component... Components>
+   using SortedRegistry = BasicRegistry<SortedTypeList<Components...>>;
+}
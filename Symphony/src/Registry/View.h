@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../Common.h"
+#include "../Container/PackedArray.h"
+#include "../Util/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <type_traits>
+
+namespace Symphony
+{
+   // Joins the pools of the given component types. The pools are bound when the view is created, iteration walks the
+   // smallest pool and filters candidates by the registry's signature instead of probing every other pool.
+   template<typename RegistryType, Component... Ts>
+   class View
+   {
+      static_assert(sizeof...(Ts) > 0, "View: At least one component type is required.");
+
+   public:
+      View(RegistryType& registry, PackedArray<Entity, Ts>&... pools) :
+         m_registry(registry),
+         m_pools(&pools...)
+      {}
+
+      template<typename Func>
+      void ForEach(Func&& func)
+      {
+         size_t smallest = SmallestPool();
+         VisitPool(smallest, [&](auto& pool)
+         {
+            // Iterate backwards so func may remove the current entity's components without skipping any
+            for (size_t i = pool.Size(); i-- > 0;)
+            {
+               Entity entity = pool.GetEntityAtIndex(i);
+               if (m_registry.template Has<Ts...>(entity))
+                  func(entity, std::get<PackedArray<Entity, Ts>*>(m_pools)->Get(entity)...);
+            }
+         });
+      }
+
+      // Splits the smallest pool into cache line aligned chunks and runs func(entity, components...) for each match on
+      // the pool's threads. Only the smallest pool is chunked by cache line, components of the other pools are reached
+      // through their sparse sets and may share lines across threads. No pool may be structurally modified until the
+      // call returns.
+      template<typename Func>
+      void ParallelForEach(Func&& func, ThreadPool& threadPool = ThreadPool::Shared())
+      {
+         size_t smallest = SmallestPool();
+         VisitPool(smallest, [&](auto& pool)
+         {
+            using Comp = typename std::remove_reference_t<decltype(pool)>::ComponentType;
+            ParallelFor(threadPool, pool.Size(), CacheLineGranularity(sizeof(Comp)), [&](size_t begin, size_t end, size_t)
+            {
+               for (size_t i = begin; i < end; ++i)
+               {
+                  Entity entity = pool.GetEntityAtIndex(i);
+                  if (m_registry.template Has<Ts...>(entity))
+                     func(entity, std::get<PackedArray<Entity, Ts>*>(m_pools)->Get(entity)...);
+               }
+            });
+         });
+      }
+
+      // Like ParallelForEach, func(accumulator, entity, components...) reduces each match into a per-thread copy of
+      // identity and the copies are folded with combine(lhs, rhs) once every chunk is done
+      template<typename Acc, typename Func, typename Combine>
+      Acc ParallelReduce(const Acc& identity, Func&& func, Combine&& combine, ThreadPool& threadPool = ThreadPool::Shared())
+      {
+         Acc result = identity;
+         size_t smallest = SmallestPool();
+         VisitPool(smallest, [&](auto& pool)
+         {
+            using Comp = typename std::remove_reference_t<decltype(pool)>::ComponentType;
+            result = Symphony::ParallelReduce(threadPool, pool.Size(), CacheLineGranularity(sizeof(Comp)), identity, [&](Acc& accumulator, size_t begin, size_t end)
+            {
+               for (size_t i = begin; i < end; ++i)
+               {
+                  Entity entity = pool.GetEntityAtIndex(i);
+                  if (m_registry.template Has<Ts...>(entity))
+                     func(accumulator, entity, std::get<PackedArray<Entity, Ts>*>(m_pools)->Get(entity)...);
+               }
+            }, combine);
+         });
+         return result;
+      }
+
+      [[nodiscard]] size_t SizeHint() const
+      {
+         std::array<size_t, sizeof...(Ts)> sizes = { std::get<PackedArray<Entity, Ts>*>(m_pools)->Size()... };
+         return *std::min_element(sizes.begin(), sizes.end());
+      }
+
+   private:
+      size_t SmallestPool() const
+      {
+         std::array<size_t, sizeof...(Ts)> sizes = { std::get<PackedArray<Entity, Ts>*>(m_pools)->Size()... };
+         return std::distance(sizes.begin(), std::min_element(sizes.begin(), sizes.end()));
+      }
+
+      template<typename Func>
+      void VisitPool(size_t index, Func&& func)
+      {
+         size_t current = 0;
+         ((current++ == index ? func(*std::get<PackedArray<Entity, Ts>*>(m_pools)) : void()), ...);
+      }
+
+      RegistryType& m_registry;
+      std::tuple<PackedArray<Entity, Ts>*...> m_pools;
+   };
+}
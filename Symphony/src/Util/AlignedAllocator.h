@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace Symphony
+{
+   static constexpr size_t CACHE_LINE_SIZE = 64;
+
+   // Allocator that starts every block on a cache line, so element offsets map to fixed cache lines
+   template<typename T, size_t Alignment = CACHE_LINE_SIZE>
+   class AlignedAllocator
+   {
+      static_assert(Alignment >= alignof(T), "AlignedAllocator: Alignment must satisfy the type's own alignment.");
+
+   public:
+      using value_type = T;
+
+      template<typename U>
+      using rebind_alloc = AlignedAllocator<U, Alignment>;
+
+      template<typename U>
+      struct rebind
+      {
+         using other = AlignedAllocator<U, Alignment>;
+      };
+
+      AlignedAllocator() noexcept = default;
+
+      template<typename U>
+      AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+      [[nodiscard]] T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+
+      void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+      template<typename U>
+      bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+   };
+}
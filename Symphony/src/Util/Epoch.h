@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../Common.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Symphony
+{
+   // Epoch based reclamation. Readers pin the current epoch while they hold pointers into shared memory, writers retire
+   // replaced blocks instead of freeing them, and a retired block is only freed once every pinned reader has moved past
+   // the epoch it was retired in.
+   class EpochManager
+   {
+      static constexpr size_t MAX_READERS = 128; // Pinning spins while this many readers are already pinned
+      static constexpr uint64_t INACTIVE = std::numeric_limits<uint64_t>::max();
+
+      struct alignas(64) Slot
+      {
+         std::atomic<uint64_t> epoch = INACTIVE;
+      };
+
+      struct Retired
+      {
+         void* pointer;
+         void (*deleter)(void*);
+         uint64_t epoch;
+      };
+
+   public:
+      class Guard
+      {
+      public:
+         explicit Guard(EpochManager& manager) :
+            m_manager(manager),
+            m_slot(manager.Pin())
+         {}
+
+         ~Guard() { m_manager.Unpin(m_slot); }
+
+         Guard(const Guard&) = delete;
+         Guard& operator=(const Guard&) = delete;
+
+      private:
+         EpochManager& m_manager;
+         size_t m_slot;
+      };
+
+      EpochManager() = default;
+
+      ~EpochManager()
+      {
+         for (auto& retired : m_retired)
+            retired.deleter(retired.pointer);
+      }
+
+      EpochManager(const EpochManager&) = delete;
+      EpochManager& operator=(const EpochManager&) = delete;
+
+      // The replacement for pointer must already be published before it is retired
+      template<typename T>
+      void Retire(T* pointer, void (*deleter)(void*) = [](void* p) { delete[] static_cast<T*>(p); })
+      {
+         uint64_t epoch = m_globalEpoch.fetch_add(1);
+
+         std::lock_guard lock(m_retiredMutex);
+         m_retired.push_back({ pointer, deleter, epoch });
+         Collect();
+      }
+
+      size_t PendingCount()
+      {
+         std::lock_guard lock(m_retiredMutex);
+         return m_retired.size();
+      }
+
+   private:
+      size_t Pin()
+      {
+         for (;;)
+         {
+            for (size_t i = 0; i < MAX_READERS; ++i)
+            {
+               uint64_t expected = INACTIVE;
+               if (m_slots[i].epoch.load(std::memory_order_relaxed) != INACTIVE)
+                  continue;
+               if (m_slots[i].epoch.compare_exchange_strong(expected, m_globalEpoch.load()))
+                  return i;
+            }
+         }
+      }
+
+      void Unpin(size_t slot) { m_slots[slot].epoch.store(INACTIVE, std::memory_order_release); }
+
+      // Caller holds m_retiredMutex
+      void Collect()
+      {
+         uint64_t oldestPinned = INACTIVE;
+         for (auto& slot : m_slots)
+            oldestPinned = std::min(oldestPinned, slot.epoch.load());
+
+         std::erase_if(m_retired, [oldestPinned](const Retired& retired)
+         {
+            if (retired.epoch >= oldestPinned)
+               return false;
+            retired.deleter(retired.pointer);
+            return true;
+         });
+      }
+
+      std::atomic<uint64_t> m_globalEpoch = 0;
+      std::array<Slot, MAX_READERS> m_slots;
+      std::mutex m_retiredMutex;
+      std::vector<Retired> m_retired;
+   };
+}
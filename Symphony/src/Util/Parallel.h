@@ -0,0 +1,140 @@
+#pragma once
+
+#include "../Common.h"
+#include "AlignedAllocator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Symphony
+{
+   // Ranges smaller than this run on the calling thread, dispatch would cost more than it saves
+   static constexpr size_t PARALLEL_SERIAL_THRESHOLD = 4096;
+
+   // Chunks handed to each participant on average, more chunks balance uneven work at the cost of more claims
+   static constexpr size_t PARALLEL_CHUNKS_PER_THREAD = 8;
+
+   // Smallest number of elements of elementSize bytes that spans a whole number of cache lines. As long as the array
+   // starts on a cache line, chunk boundaries that are multiples of this never split a line between two threads.
+   [[nodiscard]] constexpr size_t CacheLineGranularity(size_t elementSize)
+   {
+      return CACHE_LINE_SIZE / std::gcd(elementSize, CACHE_LINE_SIZE);
+   }
+
+   // Each participant reduces into its own accumulator, padded so neighbouring accumulators never share a line
+   template<typename T>
+   struct alignas(CACHE_LINE_SIZE) PaddedAccumulator
+   {
+      T value;
+   };
+
+   [[nodiscard]] inline size_t ParallelParticipants(ThreadPool& pool, size_t count, size_t granularity)
+   {
+      if (count < PARALLEL_SERIAL_THRESHOLD)
+         return 1;
+
+      size_t chunks = (count + granularity - 1) / granularity;
+      return std::max<size_t>(1, std::min(pool.WorkerCount() + 1, chunks));
+   }
+
+   // Splits [begin, end) into chunks and runs func(chunkBegin, chunkEnd, participant) on the calling thread and the
+   // pool's workers. Chunk boundaries fall on multiples of granularity measured from index 0, not from begin, so a
+   // sub-range of a cache line aligned array is still split on cache lines. Participants claim the next unprocessed
+   // chunk from a shared counter, so a participant that finishes early keeps taking work from the slower ones.
+   // participant is dense in [0, ParallelParticipants(pool, end - begin, granularity)) and can index per-thread state.
+   template<typename Func>
+   void ParallelFor(ThreadPool& pool, size_t begin, size_t end, size_t granularity, Func&& func)
+   {
+      if (begin >= end)
+         return;
+
+      size_t count = end - begin;
+      size_t participants = ParallelParticipants(pool, count, granularity);
+      if (participants == 1)
+      {
+         func(begin, end, size_t(0));
+         return;
+      }
+
+      size_t chunkSize = std::max(count / (participants * PARALLEL_CHUNKS_PER_THREAD), granularity);
+      chunkSize = (chunkSize + granularity - 1) / granularity * granularity;
+
+      size_t alignedBegin = begin / granularity * granularity;
+      size_t chunkCount = (end - alignedBegin + chunkSize - 1) / chunkSize;
+
+      std::atomic<size_t> nextChunk = 0;
+      std::atomic<size_t> nextParticipant = 0;
+      auto drain = [&]
+      {
+         size_t participant = nextParticipant.fetch_add(1, std::memory_order_relaxed);
+         for (size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount; chunk = nextChunk.fetch_add(1, std::memory_order_relaxed))
+         {
+            size_t chunkBegin = alignedBegin + chunk * chunkSize;
+            func(std::max(chunkBegin, begin), std::min(chunkBegin + chunkSize, end), participant);
+         }
+      };
+
+      std::latch done(participants - 1);
+      for (size_t i = 1; i < participants; ++i)
+         pool.Submit([&] { drain(); done.count_down(); });
+
+      drain();
+      pool.WaitHelping(done);
+   }
+
+   template<typename Func>
+   void ParallelFor(ThreadPool& pool, size_t count, size_t granularity, Func&& func)
+   {
+      ParallelFor(pool, size_t(0), count, granularity, std::forward<Func>(func));
+   }
+
+   // Like ParallelFor, func(accumulator, begin, end) reduces each chunk into its participant's copy of identity. The
+   // copies are folded with combine(lhs, rhs) on the calling thread once every chunk is done.
+   template<typename Acc, typename Func, typename Combine>
+   Acc ParallelReduce(ThreadPool& pool, size_t count, size_t granularity, const Acc& identity, Func&& func, Combine&& combine)
+   {
+      std::vector<PaddedAccumulator<Acc>> accumulators(ParallelParticipants(pool, count, granularity), PaddedAccumulator<Acc>{ identity });
+
+      ParallelFor(pool, count, granularity, [&](size_t begin, size_t end, size_t participant)
+      {
+         func(accumulators[participant].value, begin, end);
+      });
+
+      Acc result = identity;
+      for (auto& accumulator : accumulators)
+         result = combine(result, accumulator.value);
+      return result;
+   }
+
+   template<typename Entity, Component Comp>
+   class PackedArray;
+
+   // Runs func(entity, component) over the dense range of array in cache line aligned chunks. PackedArray stores its
+   // components from a cache line boundary, so writes through component never share a line with another thread's
+   // chunk. array must not be structurally modified until the call returns.
+   template<typename Entity, Component Comp, typename Func>
+   void ParallelForEach(PackedArray<Entity, Comp>& array, Func&& func, ThreadPool& pool = ThreadPool::Shared())
+   {
+      ParallelFor(pool, array.Size(), CacheLineGranularity(sizeof(Comp)), [&](size_t begin, size_t end, size_t)
+      {
+         for (size_t i = begin; i < end; ++i)
+            func(array.GetEntityAtIndex(i), array.GetByIndex(i));
+      });
+   }
+
+   // Like ParallelForEach, func(accumulator, entity, component) reduces into a per-thread copy of identity
+   template<typename Entity, Component Comp, typename Acc, typename Func, typename Combine>
+   Acc ParallelReduce(PackedArray<Entity, Comp>& array, const Acc& identity, Func&& func, Combine&& combine, ThreadPool& pool = ThreadPool::Shared())
+   {
+      return ParallelReduce(pool, array.Size(), CacheLineGranularity(sizeof(Comp)), identity, [&](Acc& accumulator, size_t begin, size_t end)
+      {
+         for (size_t i = begin; i < end; ++i)
+            func(accumulator, array.GetEntityAtIndex(i), array.GetByIndex(i));
+      }, std::forward<Combine>(combine));
+   }
+}
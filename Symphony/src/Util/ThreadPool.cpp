@@ -0,0 +1,10 @@
+#include "ThreadPool.h"
+
+namespace Symphony
+{
+   ThreadPool& ThreadPool::Shared()
+   {
+      static ThreadPool sharedInstance;
+      return sharedInstance;
+   }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../Common.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Symphony
+{
+   class ThreadPool
+   {
+   public:
+      explicit ThreadPool(size_t workerCount = std::max(std::thread::hardware_concurrency(), 2U) - 1)
+      {
+         m_workers.reserve(workerCount);
+         for (size_t i = 0; i < workerCount; ++i)
+            m_workers.emplace_back([this] { WorkerLoop(); });
+      }
+
+      ~ThreadPool()
+      {
+         {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+         }
+         m_condition.notify_all();
+
+         for (auto& worker : m_workers)
+            worker.join();
+      }
+
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+
+      void Submit(std::function<void()> task)
+      {
+         {
+            std::lock_guard lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+         }
+         m_condition.notify_one();
+      }
+
+      // Runs queued tasks on the calling thread until latch is released, so a task may itself wait on nested work
+      void WaitHelping(std::latch& latch)
+      {
+         while (!latch.try_wait())
+         {
+            if (!TryRunOne())
+               std::this_thread::yield();
+         }
+      }
+
+      size_t WorkerCount() const { return m_workers.size(); }
+
+      // Defined in ThreadPool.cpp so every module linking Symphony shares one instance
+      SYMPHONY_API static ThreadPool& Shared();
+
+   private:
+      bool TryRunOne()
+      {
+         std::function<void()> task;
+         {
+            std::lock_guard lock(m_mutex);
+            if (m_tasks.empty())
+               return false;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+         }
+         task();
+         return true;
+      }
+
+      void WorkerLoop()
+      {
+         for (;;)
+         {
+            std::function<void()> task;
+            {
+               std::unique_lock lock(m_mutex);
+               m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+               if (m_stopping && m_tasks.empty())
+                  return;
+               task = std::move(m_tasks.front());
+               m_tasks.pop_front();
+            }
+            task();
+         }
+      }
+
+      std::vector<std::thread> m_workers;
+      std::deque<std::function<void()>> m_tasks;
+      std::mutex m_mutex;
+      std::condition_variable m_condition;
+      bool m_stopping = false;
+   };
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../Common.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Symphony
+{
+   template<typename... Types>
+   struct TypeList
+   {
+      static constexpr size_t Size = sizeof...(Types);
+   };
+
+   template<size_t Index, typename... Types>
+   using TypeAt = std::tuple_element_t<Index, std::tuple<Types...>>;
+
+   template<typename T, typename... Types>
+   inline constexpr bool ContainsType = (std::is_same_v<T, Types> || ...);
+
+   template<typename T, typename... Types>
+   requires ContainsType<T, Types...>
+   inline constexpr size_t IndexOfType = []
+   {
+      constexpr bool matches[] = { std::is_same_v<T, Types>... };
+      size_t index = 0;
+      while (!matches[index])
+         ++index;
+      return index;
+   }();
+
+   template<typename... Types>
+   inline constexpr bool UniqueTypes = []<size_t... I>(std::index_sequence<I...>)
+   {
+      // Every type must be found at its own position, a duplicate is found at the position of its first occurrence
+      return ((IndexOfType<TypeAt<I, Types...>, Types...> == I) && ...);
+   }(std::index_sequence_for<Types...>{});
+
+   // Extracts the type name from the compiler's pretty function signature at compile time. The result only depends on
+   // the spelling of the type, so it is identical in every module compiled with the same toolchain.
+   template<typename T>
+   [[nodiscard]] constexpr std::string_view TypeName()
+   {
+#if defined(_MSC_VER)
+      constexpr std::string_view signature = __FUNCSIG__;
+      constexpr std::string_view prefix = "TypeName<";
+      constexpr std::string_view suffix = ">(void)";
+      constexpr size_t start = signature.find(prefix) + prefix.size();
+      constexpr size_t end = signature.rfind(suffix);
+#else
+      constexpr std::string_view signature = __PRETTY_FUNCTION__;
+      constexpr std::string_view prefix = "T = ";
+      constexpr size_t start = signature.find(prefix) + prefix.size();
+      constexpr size_t end = signature.find_first_of(";]", start);
+#endif
+      return signature.substr(start, end - start);
+   }
+
+   // 32-bit FNV-1a
+   [[nodiscard]] constexpr uint32_t HashString(std::string_view string)
+   {
+      uint32_t hash = 2166136261U;
+      for (char c : string)
+      {
+         hash ^= static_cast<uint8_t>(c);
+         hash *= 16777619U;
+      }
+      return hash;
+   }
+
+   // Component IDs are derived from the type name rather than from a static counter. A counter would be incremented
+   // separately on each side of the SYMPHONY_API boundary and hand out different IDs for the same type.
+   template<Component T>
+   struct ComponentTypeID
+   {
+   private:
+      static constexpr ComponentID Hash = HashString(TypeName<std::remove_cvref_t<T>>());
+
+   public:
+      static constexpr ComponentID value = Hash == NULL_COMPONENT ? Hash - 1 : Hash;
+   };
+
+   template<Component T>
+   inline constexpr ComponentID ComponentTypeIDValue = ComponentTypeID<T>::value;
+
+   template<typename... Types>
+   inline constexpr bool UniqueComponentIDs = []
+   {
+      std::array<ComponentID, sizeof...(Types)> ids = { ComponentTypeIDValue<Types>... };
+      std::sort(ids.begin(), ids.end());
+      return std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+   }();
+
+   template<typename... Types>
+   struct SortByComponentID
+   {
+   private:
+      static constexpr std::array<ComponentID, sizeof...(Types)> IDS = { ComponentTypeIDValue<Types>... };
+
+      static constexpr std::array<size_t, sizeof...(Types)> ORDER = []
+      {
+         std::array<size_t, sizeof...(Types)> order = {};
+         for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+         std::sort(order.begin(), order.end(), [](size_t lhs, size_t rhs) { return IDS[lhs] < IDS[rhs]; });
+         return order;
+      }();
+
+      template<size_t... I>
+      static auto Make(std::index_sequence<I...>) -> TypeList<TypeAt<ORDER[I], Types...>...>;
+
+   public:
+      using Type = decltype(Make(std::index_sequence_for<Types...>{}));
+   };
+
+   template<typename... Types>
+   using SortedTypeList = typename SortByComponentID<Types...>::Type;
+}
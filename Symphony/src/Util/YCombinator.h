@@ -8,6 +8,7 @@ namespace Symphony
    template<typename Func>
    class YCombinator
    {
+   public:
       constexpr YCombinator(Func recursive) noexcept(std::is_nothrow_move_constructible_v<Func>) :
          m_lambda(std::move(recursive))
       {}
@@ -0,0 +1,145 @@
+#include "Container/ConcurrentSparseSet.h"
+
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Symphony;
+
+namespace
+{
+   // Every value a reader can observe is derived from its key, so a torn or stale publication shows up as a mismatch
+   constexpr uint64_t ValueOf(uint32_t key) { return uint64_t(key) * 2 + 1; }
+}
+
+namespace SymphonyTests
+{
+   void ConcurrentSparseSetStressTest()
+   {
+      constexpr int WRITER_COUNT = 4;
+      constexpr int READER_COUNT = 4;
+      constexpr int OPERATIONS_PER_WRITER = 200000;
+      constexpr uint32_t KEYS_PER_WRITER = 100000;
+
+      ConcurrentSparseSet<uint32_t, uint64_t> set;
+      std::atomic<bool> stop = false;
+      std::atomic<size_t> mismatches = 0;
+
+      // Writers own disjoint keys (key % WRITER_COUNT) but share pages, so every shard sees contention
+      std::vector<std::thread> writers;
+      for (int w = 0; w < WRITER_COUNT; ++w)
+      {
+         writers.emplace_back([&, w]
+         {
+            std::mt19937 rng(w);
+            for (int i = 0; i < OPERATIONS_PER_WRITER; ++i)
+            {
+               uint32_t key = (rng() % KEYS_PER_WRITER) * WRITER_COUNT + w;
+               if (rng() & 1)
+                  set.Insert(key, ValueOf(key));
+               else
+                  set.Remove(key);
+            }
+         });
+      }
+
+      std::vector<std::thread> readers;
+      for (int r = 0; r < READER_COUNT; ++r)
+      {
+         readers.emplace_back([&, r]
+         {
+            std::mt19937 rng(100 + r);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+               for (int i = 0; i < 1000; ++i)
+               {
+                  uint32_t key = rng() % (KEYS_PER_WRITER * WRITER_COUNT);
+                  uint64_t value = set.Get(key);
+                  if (value != set.InvalidValue && value != ValueOf(key))
+                     ++mismatches;
+               }
+
+               set.ForEach([&](uint32_t key, uint64_t value)
+               {
+                  if (value != ValueOf(key))
+                     ++mismatches;
+               });
+            }
+         });
+      }
+
+      for (auto& writer : writers)
+         writer.join();
+      stop = true;
+      for (auto& reader : readers)
+         reader.join();
+
+      SYMPHONY_CHECK(mismatches.load() == 0);
+
+      // Quiescent again, every view of the set has to agree
+      size_t visited = 0;
+      set.ForEach([&](uint32_t, uint64_t) { ++visited; });
+
+      size_t present = 0;
+      for (uint32_t key = 0; key < KEYS_PER_WRITER * WRITER_COUNT; ++key)
+         present += set.Contains(key);
+
+      SYMPHONY_CHECK(visited == set.Size());
+      SYMPHONY_CHECK(present == set.Size());
+   }
+
+   // 90% Get, 10% Insert/Remove over a half full set of 2^20 keys, the same total work split across 1 to 32 threads
+   void ConcurrentSparseSetBenchmark()
+   {
+      constexpr uint32_t KEY_MASK = (1U << 20) - 1;
+      constexpr size_t OPERATIONS = 8000000;
+
+      std::printf("ConcurrentSparseSet scaling (%u hardware threads)\n", std::thread::hardware_concurrency());
+      for (size_t threadCount : { 1, 2, 4, 8, 16, 32 })
+      {
+         ConcurrentSparseSet<uint32_t, uint64_t> set;
+         for (uint32_t key = 0; key <= KEY_MASK; key += 2)
+            set.Insert(key, key);
+
+         auto start = std::chrono::steady_clock::now();
+
+         std::vector<std::thread> threads;
+         std::atomic<uint64_t> sink = 0;
+         for (size_t t = 0; t < threadCount; ++t)
+         {
+            threads.emplace_back([&, t]
+            {
+               std::mt19937 rng { uint32_t(t) };
+               uint64_t accumulator = 0;
+               for (size_t i = 0; i < OPERATIONS / threadCount; ++i)
+               {
+                  uint32_t key = rng() & KEY_MASK;
+                  if (i % 10 == 0)
+                  {
+                     if (key & 1)
+                        set.Insert(key, key);
+                     else
+                        set.Remove(key);
+                  }
+                  else
+                  {
+                     accumulator += set.Get(key);
+                  }
+               }
+               sink += accumulator;
+            });
+         }
+
+         for (auto& thread : threads)
+            thread.join();
+
+         double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         std::printf("   threads %2zu: %7.1f Mops/s\n", threadCount, OPERATIONS / seconds / 1e6);
+      }
+   }
+}
@@ -0,0 +1,233 @@
+#include "Container/DoubleBufferedArray.h"
+
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace Symphony;
+
+namespace
+{
+   struct Stamp
+   {
+      Entity entity = 0;
+      uint64_t value = 0;
+   };
+
+   using Array = DoubleBufferedArray<Entity, Stamp>;
+   using Snapshot = std::map<Entity, uint64_t>;
+
+   constexpr Entity ENTITY_RANGE = 2000;
+
+   // One frame of random Add/Remove/writes, mirrored into the reference
+   void SimulateFrame(Array& array, Snapshot& reference, std::mt19937& rng, uint64_t frame)
+   {
+      for (int i = 0; i < 40; ++i)
+      {
+         Entity entity = rng() % ENTITY_RANGE;
+         uint64_t value = frame * 100000 + rng() % 100000;
+         switch (rng() % 4)
+         {
+         case 0:
+            if (!reference.contains(entity))
+               reference[entity] = value;
+            array.Add(entity, { entity, value });
+            break;
+         case 1:
+            reference.erase(entity);
+            array.Remove(entity);
+            break;
+         case 2:
+            if (array.Contains(entity))
+            {
+               array.Get(entity).value = value;
+               reference[entity] = value;
+            }
+            break;
+         default:
+            if (array.Size() > 0)
+            {
+               size_t index = rng() % array.Size();
+               Stamp& stamp = array.GetByIndex(index);
+               stamp.value = value;
+               reference[stamp.entity] = value;
+            }
+            break;
+         }
+      }
+   }
+
+   bool Matches(const Array::ReadHandle& handle, const Snapshot& reference)
+   {
+      Snapshot seen;
+      bool matches = handle.Size() == reference.size();
+      handle.ForEach([&](Entity entity, const Stamp& stamp)
+      {
+         matches &= stamp.entity == entity;
+         seen[entity] = stamp.value;
+      });
+      matches &= seen == reference;
+
+      for (Entity entity = 0; entity < ENTITY_RANGE; ++entity)
+      {
+         auto it = reference.find(entity);
+         const Stamp* stamp = handle.Get(entity);
+         if (it == reference.end())
+            matches &= !handle.Contains(entity) && stamp == nullptr;
+         else
+            matches &= handle.Contains(entity) && stamp != nullptr && stamp->value == it->second;
+      }
+      return matches;
+   }
+}
+
+namespace SymphonyTests
+{
+   void DoubleBufferedArrayTests()
+   {
+      // Single threaded, every snapshot compared against the reference of its frame, including after the next frame's
+      // writes have already been made to the live array
+      {
+         Array array;
+         Snapshot reference;
+         std::mt19937 rng(30);
+
+         SYMPHONY_CHECK(array.AcquireRead().Frame() == 0 && array.AcquireRead().Size() == 0);
+
+         bool framesMatch = true;
+         bool snapshotsStable = true;
+         for (uint64_t frame = 1; frame <= 3000; ++frame)
+         {
+            SimulateFrame(array, reference, rng, frame);
+            array.Publish();
+
+            Snapshot published = reference;
+            {
+               auto handle = array.AcquireRead();
+               framesMatch &= handle.Frame() == frame && Matches(handle, published);
+
+               SimulateFrame(array, reference, rng, frame + 1);
+               snapshotsStable &= handle.Frame() == frame && Matches(handle, published);
+            }
+            array.Publish();
+            ++frame;
+
+            framesMatch &= array.AcquireRead().Frame() == frame && Matches(array.AcquireRead(), reference);
+         }
+         SYMPHONY_CHECK(framesMatch);
+         SYMPHONY_CHECK(snapshotsStable);
+      }
+
+      // A concurrent reader pinning whatever front buffer is current, checked against the reference of that frame
+      {
+         Array array;
+         Snapshot reference;
+         std::map<uint64_t, Snapshot> published;
+         std::mutex publishedMutex;
+         std::atomic<bool> stop = false;
+         std::atomic<size_t> mismatches = 0;
+
+         std::thread reader([&]
+         {
+            while (!stop.load())
+            {
+               {
+                  auto handle = array.AcquireRead();
+                  if (handle.Frame() != 0)
+                  {
+                     Snapshot expected;
+                     {
+                        std::lock_guard lock(publishedMutex);
+                        expected = published.at(handle.Frame());
+                     }
+                     mismatches += !Matches(handle, expected);
+                  }
+               }
+
+               // Let the writer run between snapshots, a reader that reacquires immediately would keep a single core
+               std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+         });
+
+         std::mt19937 rng(31);
+         for (uint64_t frame = 1; frame <= 3000; ++frame)
+         {
+            SimulateFrame(array, reference, rng, frame);
+            {
+               std::lock_guard lock(publishedMutex);
+               published[frame] = reference;
+            }
+            array.Publish();
+         }
+
+         stop = true;
+         reader.join();
+         SYMPHONY_CHECK(mismatches.load() == 0);
+         SYMPHONY_CHECK(Matches(array.AcquireRead(), reference));
+      }
+
+      // A handle held across two Publish() calls, the second one has to wait for it to be released
+      {
+         Array array;
+         Snapshot reference;
+         std::mt19937 rng(32);
+
+         SimulateFrame(array, reference, rng, 1);
+         array.Publish();
+         Snapshot firstFrame = reference;
+
+         std::atomic<bool> acquired = false;
+         std::atomic<uint64_t> publishedFrames = 1;
+         bool heldSnapshotStable = false;
+         uint64_t publishedWhileHeld = 0;
+
+         std::thread reader([&]
+         {
+            auto handle = array.AcquireRead();
+            acquired = true;
+
+            // Give the writer ample time to get through the first Publish() and block in the second
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            publishedWhileHeld = publishedFrames.load();
+            heldSnapshotStable = handle.Frame() == 1 && Matches(handle, firstFrame);
+         });
+
+         while (!acquired.load())
+            std::this_thread::yield();
+
+         for (uint64_t frame = 2; frame <= 3; ++frame)
+         {
+            SimulateFrame(array, reference, rng, frame);
+            array.Publish();
+            publishedFrames = frame;
+         }
+         reader.join();
+
+         SYMPHONY_CHECK(publishedWhileHeld == 2);
+         SYMPHONY_CHECK(heldSnapshotStable);
+         SYMPHONY_CHECK(array.AcquireRead().Frame() == 3 && Matches(array.AcquireRead(), reference));
+      }
+
+      // ParallelForEach marks the whole dense range dirty, so every write reaches the next snapshot
+      {
+         Array array;
+         Snapshot reference;
+         for (Entity entity = 0; entity < 10000; ++entity)
+         {
+            array.Add(entity, { entity, 0 });
+            reference[entity] = uint64_t(entity) * 7;
+         }
+         array.Publish();
+
+         ThreadPool pool(3);
+         array.ParallelForEach([](Entity entity, Stamp& stamp) { stamp.value = uint64_t(entity) * 7; }, pool);
+         array.Publish();
+         SYMPHONY_CHECK(Matches(array.AcquireRead(), reference));
+      }
+   }
+}
@@ -0,0 +1,176 @@
+#include "Container/HierarchyArray.h"
+
+#include "Test.h"
+
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace Symphony;
+
+namespace
+{
+   struct Transform { int local = 0; int world = 0; };
+
+   using Hierarchy = HierarchyArray<Entity, Transform>;
+   using ParentMap = std::map<Entity, Entity>;
+
+   size_t ReferenceDepth(const ParentMap& parents, Entity entity)
+   {
+      size_t depth = 0;
+      for (Entity ancestor = parents.at(entity); ancestor != NULL_ENTITY; ancestor = parents.at(ancestor))
+         ++depth;
+      return depth;
+   }
+
+   Entity RandomStored(const ParentMap& parents, std::mt19937& rng)
+   {
+      auto it = parents.begin();
+      std::advance(it, rng() % parents.size());
+      return it->first;
+   }
+
+   // Compares the hierarchy against the reference parent map and checks the level order invariants
+   bool Consistent(Hierarchy& hierarchy, const ParentMap& parents)
+   {
+      bool consistent = hierarchy.Size() == parents.size();
+      for (size_t i = 0; i < hierarchy.Size(); ++i)
+      {
+         Entity entity = hierarchy.GetEntityAtIndex(i);
+         auto it = parents.find(entity);
+         if (it == parents.end())
+            return false;
+
+         Entity parent = it->second;
+         size_t parentIndex = hierarchy.GetParentIndex(i);
+         consistent &= hierarchy.GetParent(entity) == parent;
+         consistent &= hierarchy.GetDepth(entity) == ReferenceDepth(parents, entity);
+
+         if (parent == NULL_ENTITY)
+            consistent &= parentIndex == Hierarchy::NULL_INDEX;
+         else
+            consistent &= parentIndex < i && hierarchy.GetEntityAtIndex(parentIndex) == parent;
+      }
+
+      // Levels tile [0, Size()) and each holds exactly the nodes of its own depth
+      size_t expectedBegin = 0;
+      for (size_t level = 0; level < hierarchy.LevelCount(); ++level)
+      {
+         auto [begin, end] = hierarchy.LevelRange(level);
+         consistent &= begin == expectedBegin && begin < end;
+         for (size_t i = begin; i < end; ++i)
+            consistent &= ReferenceDepth(parents, hierarchy.GetEntityAtIndex(i)) == level;
+         expectedBegin = end;
+      }
+      consistent &= expectedBegin == hierarchy.Size();
+      return consistent;
+   }
+
+   bool WorldMatches(Hierarchy& hierarchy, const ParentMap& parents)
+   {
+      bool matches = true;
+      for (auto& [entity, parent] : parents)
+      {
+         int world = 0;
+         for (Entity ancestor = entity; ancestor != NULL_ENTITY; ancestor = parents.at(ancestor))
+            world += int(ancestor);
+         matches &= hierarchy.Get(entity).world == world;
+      }
+      return matches;
+   }
+}
+
+namespace SymphonyTests
+{
+   void HierarchyArrayTests()
+   {
+      Hierarchy hierarchy;
+      ParentMap parents;
+      std::mt19937 rng(29);
+
+      bool addResults = true;
+      bool setParentResults = true;
+      bool consistent = true;
+
+      for (int step = 0; step < 20000; ++step)
+      {
+         int operation = rng() % 10;
+         Entity entity = rng() % 300;
+
+         if (operation < 5)
+         {
+            Entity parent = !parents.empty() && rng() % 4 ? RandomStored(parents, rng) : NULL_ENTITY;
+            bool added = hierarchy.Add(entity, { int(entity), 0 }, parent);
+            addResults &= added == !parents.contains(entity);
+            if (added)
+               parents[entity] = parent;
+         }
+         else if (operation < 7)
+         {
+            if (!parents.contains(entity))
+               continue;
+
+            std::vector<Entity> subtree = { entity };
+            for (size_t i = 0; i < subtree.size(); ++i)
+            {
+               for (auto& [child, parent] : parents)
+               {
+                  if (parent == subtree[i])
+                     subtree.push_back(child);
+               }
+            }
+            for (Entity node : subtree)
+               parents.erase(node);
+
+            hierarchy.Remove(entity);
+         }
+         else
+         {
+            if (!parents.contains(entity))
+               continue;
+
+            Entity newParent = rng() % 4 ? RandomStored(parents, rng) : NULL_ENTITY;
+            bool cycle = false;
+            for (Entity ancestor = newParent; ancestor != NULL_ENTITY; ancestor = parents.at(ancestor))
+               cycle |= ancestor == entity;
+
+            bool moved = hierarchy.SetParent(entity, newParent);
+            setParentResults &= moved != cycle;
+            if (moved)
+               parents[entity] = newParent;
+         }
+
+         if (step % 50 == 0)
+            consistent &= Consistent(hierarchy, parents);
+      }
+
+      SYMPHONY_CHECK(addResults);
+      SYMPHONY_CHECK(setParentResults);
+      SYMPHONY_CHECK(consistent && Consistent(hierarchy, parents));
+      SYMPHONY_CHECK(!hierarchy.Contains(1000) && hierarchy.GetDepth(1000) == Hierarchy::NULL_INDEX && hierarchy.GetParent(1000) == NULL_ENTITY);
+
+      for (size_t i = 0; i < hierarchy.Size(); ++i)
+         hierarchy.GetByIndex(i).world = hierarchy.GetByIndex(i).local;
+      hierarchy.Propagate([](Transform& transform, const Transform& parent) { transform.world = transform.local + parent.world; });
+      SYMPHONY_CHECK(WorldMatches(hierarchy, parents));
+
+      ThreadPool pool(3);
+      for (size_t i = 0; i < hierarchy.Size(); ++i)
+         hierarchy.GetByIndex(i).world = hierarchy.GetByIndex(i).local;
+      hierarchy.ParallelPropagate([](Transform& transform, const Transform& parent) { transform.world = transform.local + parent.world; }, pool);
+      SYMPHONY_CHECK(WorldMatches(hierarchy, parents));
+
+      // Wide levels, so ParallelPropagate actually splits them across participants
+      Hierarchy wide;
+      wide.Add(0, { 1, 1 });
+      for (Entity e = 1; e < 20000; ++e)
+         wide.Add(e, { 1, 0 }, e < 5000 ? 0 : e % 4999 + 1);
+      wide.ParallelPropagate([](Transform& transform, const Transform& parent) { transform.world = transform.local + parent.world; }, pool);
+
+      bool propagated = wide.LevelCount() == 3;
+      for (Entity e = 1; e < 20000; ++e)
+         propagated &= wide.Get(e).world == (e < 5000 ? 2 : 3);
+      SYMPHONY_CHECK(propagated);
+   }
+}
@@ -1,8 +1,149 @@
 #include "Common.h"
+#include "Container/PackedArray.h"
+#include "Container/SparseSet.h"
+#include "Registry/Registry.h"
 
-void main()
+#include "Test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+using namespace Symphony;
+
+namespace
 {
-   auto factorial = Symphony::YCombinator([](auto self, int n) -> int { return n <= 1 ? 1 : n * self(n - 1); });
+   struct Position { float x = 0.0f, y = 0.0f; };
+   struct Velocity { float x = 0.0f, y = 0.0f; };
+   struct Health { int hp = 100; };
+
+   void SparseSetTests()
+   {
+      SparseSet<Entity, size_t> set;
+      for (Entity e = 0; e < 5000; e += 3)
+         set.Insert(e, e * 2);
+
+      SYMPHONY_CHECK(set.Size() == 1667);
+      SYMPHONY_CHECK(set.Contains(3000) && set.Get(3000) == 6000);
+      SYMPHONY_CHECK(!set.Contains(3001) && set.Get(3001) == SparseSet<Entity, size_t>::InvalidValue);
+
+      // Inserting a present key keeps its value
+      set.Insert(3000, 1);
+      SYMPHONY_CHECK(set.Get(3000) == 6000);
+
+      for (Entity e = 0; e < 5000; e += 6)
+         set.Remove(e);
+
+      bool consistent = set.Size() == 833;
+      for (Entity e = 0; e < 5000; ++e)
+         consistent &= set.Contains(e) == (e % 3 == 0 && e % 6 != 0) && (!set.Contains(e) || set.Get(e) == e * 2);
+      SYMPHONY_CHECK(consistent);
+
+      size_t visited = 0;
+      for (auto [key, value] : set)
+         visited += value == key * 2;
+      SYMPHONY_CHECK(visited == set.Size());
+
+      set.Clear();
+      SYMPHONY_CHECK(set.Size() == 0 && !set.Contains(3));
+   }
+
+   void PackedArrayTests()
+   {
+      PackedArray<Entity, Health> pool;
+      for (Entity e = 0; e < 100; ++e)
+         pool.Add(e, { int(e) });
+
+      pool.Remove(0);
+      pool.Remove(50);
+      pool.Remove(99);
+
+      bool consistent = pool.Size() == 97 && !pool.Contains(0) && !pool.Contains(50) && !pool.Contains(99);
+      for (size_t i = 0; i < pool.Size(); ++i)
+      {
+         Entity entity = pool.GetEntityAtIndex(i);
+         consistent &= pool.GetIndex(entity) == i && pool.GetByIndex(i).hp == int(entity) && pool.Get(entity).hp == int(entity);
+      }
+      SYMPHONY_CHECK(consistent);
+
+      pool.Swap(0, 10);
+      SYMPHONY_CHECK(pool.Get(pool.GetEntityAtIndex(0)).hp == int(pool.GetEntityAtIndex(0)));
+      SYMPHONY_CHECK(pool.GetIndex(pool.GetEntityAtIndex(10)) == 10);
+
+      // Removing an absent entity is a no-op and Get falls back to a default component
+      pool.Remove(50);
+      SYMPHONY_CHECK(pool.Size() == 97 && pool.Get(50).hp == Health().hp);
+   }
+
+   void RegistryTests()
+   {
+      // The spelling of the namespace and class key differs between compilers, only the type's own name is portable
+      static_assert(TypeName<Position>().ends_with("Position") && TypeName<Velocity>().ends_with("Velocity"));
+      static_assert(ComponentTypeIDValue<Position> != ComponentTypeIDValue<Velocity>);
+      static_assert(ComponentTypeIDValue<Position> != NULL_COMPONENT);
+      static_assert(Registry<Position, Velocity>::POOL_INDEX<Velocity> == 1);
+      static_assert(SortedRegistry<Position, Velocity, Health>::SIGNATURE<Position, Health> == SortedRegistry<Health, Velocity, Position>::SIGNATURE<Health, Position>);
+      static_assert(SortedRegistry<Position, Velocity, Health>::PoolIndex(ComponentTypeIDValue<Velocity>) == SortedRegistry<Position, Velocity, Health>::POOL_INDEX<Velocity>);
+
+      Registry<Position, Velocity, Health> registry;
+      for (int i = 0; i < 100; ++i)
+      {
+         Entity entity = registry.Create();
+         registry.Add<Position>(entity, { float(i), 0.0f });
+         if (i % 2)
+            registry.Add<Velocity>(entity, { 1.0f, 1.0f });
+      }
+
+      registry.Remove<Position>(3);
+      registry.Destroy(5);
+
+      SYMPHONY_CHECK(registry.Size() == 99);
+      SYMPHONY_CHECK(!registry.Has<Position>(3) && registry.Has<Velocity>(3));
+      SYMPHONY_CHECK(!registry.Valid(5) && !registry.Has<Velocity>(5));
+      SYMPHONY_CHECK(registry.Has<Position, Velocity>(7) && !registry.Has<Position, Velocity>(8));
+
+      std::set<Entity> visited;
+      float sum = 0.0f;
+      registry.GetView<Position, Velocity>().ForEach([&](Entity entity, Position& position, Velocity&)
+      {
+         visited.insert(entity);
+         sum += position.x;
+      });
+      SYMPHONY_CHECK(visited.size() == 48 && sum == 2492.0f);
+
+      SYMPHONY_CHECK(registry.Create() == 5);
+
+      SortedRegistry<Health, Position> sorted;
+      Entity entity = sorted.Create();
+      sorted.Add<Health>(entity, { 7 });
+      SYMPHONY_CHECK(sorted.Get<Health>(entity).hp == 7);
+      SYMPHONY_CHECK(sorted.GetSignature(entity) == decltype(sorted)::SIGNATURE<Health>);
+   }
+}
+
+int main(int argc, char** argv)
+{
+   bool runBenchmarks = argc > 1 && std::strcmp(argv[1], "--bench") == 0;
+
+   auto factorial = YCombinator([](auto self, int n) -> int { return n <= 1 ? 1 : n * self(n - 1); });
+   SYMPHONY_CHECK(factorial(5) == 120);
+
+   SparseSetTests();
+   PackedArrayTests();
+   RegistryTests();
+   SymphonyTests::ConcurrentSparseSetStressTest();
+   SymphonyTests::ParallelTests();
+   SymphonyTests::HierarchyArrayTests();
+   SymphonyTests::DoubleBufferedArrayTests();
+   SymphonyTests::QueryTests();
+   SymphonyTests::QueryCostModelTests();
+
+   if (runBenchmarks)
+   {
+      SymphonyTests::ConcurrentSparseSetBenchmark();
+      SymphonyTests::QueryCostBenchmark();
+   }
 
-   int result = factorial(5);
-}
\ No newline at end of file
+   std::printf("%s: %d failure(s)\n", SymphonyTests::FailureCount() ? "FAILED" : "PASSED", SymphonyTests::FailureCount());
+   return SymphonyTests::FailureCount() ? 1 : 0;
+}
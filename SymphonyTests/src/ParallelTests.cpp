@@ -0,0 +1,147 @@
+#include "Container/PackedArray.h"
+#include "Registry/Registry.h"
+#include "Util/Parallel.h"
+
+#include "Test.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace Symphony;
+
+namespace
+{
+   struct Mass { uint64_t value = 0; };
+   struct Position { float x = 0.0f; };
+   struct Velocity { float x = 0.0f; };
+
+   // Runs ParallelFor over [begin, end) and checks every index is visited exactly once and every interior chunk
+   // boundary lands on a multiple of granularity, measured from index 0
+   void CheckCoverage(ThreadPool& pool, size_t begin, size_t end, size_t granularity)
+   {
+      std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[end]());
+      std::mutex boundaryMutex;
+      std::vector<size_t> boundaries;
+
+      ParallelFor(pool, begin, end, granularity, [&](size_t chunkBegin, size_t chunkEnd, size_t)
+      {
+         for (size_t i = chunkBegin; i < chunkEnd; ++i)
+            ++hits[i];
+
+         std::lock_guard lock(boundaryMutex);
+         boundaries.push_back(chunkBegin);
+         boundaries.push_back(chunkEnd);
+      });
+
+      bool covered = true;
+      for (size_t i = 0; i < end; ++i)
+         covered &= hits[i].load() == (i >= begin ? 1 : 0);
+      SYMPHONY_CHECK(covered);
+
+      bool aligned = true;
+      for (size_t boundary : boundaries)
+         aligned &= boundary == begin || boundary == end || boundary % granularity == 0;
+      SYMPHONY_CHECK(aligned);
+   }
+
+   void PackedArrayParallelTests(ThreadPool& pool)
+   {
+      PackedArray<Entity, Mass> masses;
+      for (Entity e = 0; e < 50000; ++e)
+         masses.Add(e, { uint64_t(e) * 3 + 1 });
+      for (Entity e = 0; e < 50000; e += 7)
+         masses.Remove(e);
+
+      uint64_t serialSum = 0;
+      for (size_t i = 0; i < masses.Size(); ++i)
+         serialSum += masses.GetByIndex(i).value;
+
+      auto sum = [](uint64_t& accumulator, Entity, Mass& mass) { accumulator += mass.value; };
+      auto combine = [](uint64_t a, uint64_t b) { return a + b; };
+      SYMPHONY_CHECK(ParallelReduce(masses, uint64_t(0), sum, combine, pool) == serialSum);
+
+      // Entity/component pairing must survive the parallel split
+      auto mismatches = ParallelReduce(masses, size_t(0), [](size_t& accumulator, Entity entity, Mass& mass)
+      {
+         accumulator += mass.value != uint64_t(entity) * 3 + 1;
+      }, [](size_t a, size_t b) { return a + b; }, pool);
+      SYMPHONY_CHECK(mismatches == 0);
+
+      ParallelForEach(masses, [](Entity, Mass& mass) { mass.value *= 2; }, pool);
+      SYMPHONY_CHECK(ParallelReduce(masses, uint64_t(0), sum, combine, pool) == serialSum * 2);
+
+      PackedArray<Entity, Mass> few;
+      for (Entity e = 0; e < 10; ++e)
+         few.Add(e, { 1 });
+      SYMPHONY_CHECK(ParallelReduce(few, uint64_t(0), sum, combine, pool) == 10);
+   }
+
+   void ViewParallelTests(ThreadPool& pool)
+   {
+      Registry<Position, Velocity> registry;
+      std::vector<Entity> moving;
+      for (int i = 0; i < 30000; ++i)
+      {
+         Entity entity = registry.Create();
+         registry.Add<Position>(entity, { float(i) });
+         if (i % 3 != 0)
+         {
+            registry.Add<Velocity>(entity, { 1.0f });
+            moving.push_back(entity);
+         }
+      }
+
+      // Velocity without Position must be skipped, so the smallest pool holds non-matching candidates
+      for (int i = 0; i < 1000; ++i)
+         registry.Add<Velocity>(registry.Create(), { 1.0f });
+
+      std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[registry.Size()]());
+      registry.GetView<Position, Velocity>().ParallelForEach([&](Entity entity, Position& position, Velocity& velocity)
+      {
+         ++hits[entity];
+         position.x += velocity.x;
+      }, pool);
+
+      bool visitedOnce = true;
+      for (Entity entity = 0; entity < registry.Size(); ++entity)
+         visitedOnce &= hits[entity].load() == (registry.Has<Position, Velocity>(entity) ? 1 : 0);
+      SYMPHONY_CHECK(visitedOnce);
+
+      bool moved = true;
+      for (Entity entity : moving)
+         moved &= registry.Get<Position>(entity).x == float(entity) + 1.0f;
+      SYMPHONY_CHECK(moved);
+
+      uint64_t serialSum = 0;
+      registry.GetView<Position, Velocity>().ForEach([&](Entity entity, Position&, Velocity&) { serialSum += entity; });
+
+      uint64_t parallelSum = registry.GetView<Velocity, Position>().ParallelReduce(uint64_t(0), [](uint64_t& accumulator, Entity entity, Velocity&, Position&)
+      {
+         accumulator += entity;
+      }, [](uint64_t a, uint64_t b) { return a + b; }, pool);
+      SYMPHONY_CHECK(parallelSum == serialSum && serialSum > 0);
+   }
+}
+
+namespace SymphonyTests
+{
+   void ParallelTests()
+   {
+      SYMPHONY_CHECK(&ThreadPool::Shared() == &ThreadPool::Shared());
+      SYMPHONY_CHECK(CacheLineGranularity(sizeof(float)) == 16 && CacheLineGranularity(12) == 16 && CacheLineGranularity(64) == 1);
+
+      ThreadPool pool(3);
+
+      CheckCoverage(pool, 0, 100000, 16);
+      CheckCoverage(pool, 1234, 100000, 16);
+      CheckCoverage(pool, 4097, 9001, 3);
+      CheckCoverage(pool, 5, 700, 16);      // Below the serial threshold
+      CheckCoverage(pool, 10, 10, 16);      // Empty
+
+      PackedArrayParallelTests(pool);
+      ViewParallelTests(pool);
+   }
+}
@@ -0,0 +1,275 @@
+#include "Registry/Registry.h"
+
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Symphony;
+
+namespace
+{
+   struct A { int value = 0; };
+   struct B { int value = 0; };
+   struct C { int value = 0; };
+   struct D { int value = 0; };
+
+   using TestRegistry = Registry<A, B, C, D>;
+
+   template<Component... Ts>
+   std::set<Entity> ViewMatches(TestRegistry& registry)
+   {
+      std::set<Entity> matches;
+      registry.GetView<Ts...>().ForEach([&](Entity entity, Ts&...) { matches.insert(entity); });
+      return matches;
+   }
+
+   template<Component... Ts>
+   std::set<Entity> QueryMatches(Query<TestRegistry, Ts...>& query)
+   {
+      std::set<Entity> matches;
+      query.ForEach([&](Entity entity, Ts&...) { matches.insert(entity); });
+      return matches;
+   }
+}
+
+namespace SymphonyTests
+{
+   void QueryTests()
+   {
+      TestRegistry registry;
+      std::mt19937 rng(31);
+
+      for (int i = 0; i < 500; ++i)
+      {
+         Entity entity = registry.Create();
+         registry.Add<A>(entity, { int(entity) });
+         if (rng() % 2)
+            registry.Add<B>(entity, { int(entity) });
+      }
+
+      // <A, B> and <B, A> have the same mask and must share one storage, including its stats
+      auto queryAB = registry.GetQuery<A, B>();
+      auto queryBA = registry.GetQuery<B, A>();
+      auto queryABC = registry.GetQuery<A, B, C>();
+      SYMPHONY_CHECK(&queryAB.GetStats() == &queryBA.GetStats());
+      SYMPHONY_CHECK(&queryAB.GetStats() != &queryABC.GetStats());
+      SYMPHONY_CHECK(QueryMatches(queryAB) == ViewMatches<A, B>(registry));
+
+      bool matchesView = true;
+      bool componentsMatch = true;
+      size_t destroyed = 0;
+      for (int step = 0; step < 20000; ++step)
+      {
+         Entity entity = rng() % 520;
+         int operation = rng() % 9;
+
+         if (operation == 0)
+            registry.Create();
+         else if (operation == 1)
+         {
+            destroyed += registry.Valid(entity);
+            registry.Destroy(entity);
+         }
+         else if (!registry.Valid(entity))
+            continue;
+         else if (operation == 2)
+            registry.Add<A>(entity, { int(entity) });
+         else if (operation == 3)
+            registry.Add<B>(entity, { int(entity) });
+         else if (operation == 4)
+            registry.Add<C>(entity, { int(entity) });
+         else if (operation == 5)
+            registry.Add<D>(entity);
+         else if (operation == 6)
+            registry.Remove<A>(entity);
+         else if (operation == 7)
+            registry.Remove<B>(entity);
+         else
+            registry.Remove<C>(entity);
+
+         if (step % 100 == 0)
+         {
+            std::set<Entity> viewAB = ViewMatches<A, B>(registry);
+            matchesView &= QueryMatches(queryAB) == viewAB && QueryMatches(queryBA) == viewAB && queryBA.Size() == viewAB.size();
+            matchesView &= QueryMatches(queryABC) == ViewMatches<A, B, C>(registry);
+
+            // Components are read through the stored dense indices, which must follow every swap in the pools
+            queryABC.ForEach([&](Entity entity, A& a, B& b, C& c) { componentsMatch &= a.value == int(entity) && b.value == int(entity) && c.value == int(entity); });
+            queryBA.ForEach([&](Entity entity, B& b, A& a) { componentsMatch &= a.value == int(entity) && b.value == int(entity); });
+         }
+      }
+
+      SYMPHONY_CHECK(destroyed > 0);
+      SYMPHONY_CHECK(matchesView);
+      SYMPHONY_CHECK(componentsMatch);
+
+      // Destroy leaves no stale matches behind
+      for (Entity entity : QueryMatches(queryABC))
+         registry.Destroy(entity);
+      SYMPHONY_CHECK(queryABC.Size() == 0 && QueryMatches(queryAB) == ViewMatches<A, B>(registry));
+
+      // A query built after the fact starts from the current signatures
+      auto queryAD = registry.GetQuery<D, A>();
+      SYMPHONY_CHECK(QueryMatches(queryAD) == ViewMatches<A, D>(registry));
+
+      // Serial ForEach iterates backwards, so removing the current entity's components is allowed there
+      queryAB.ForEach([&](Entity entity, A&, B&) { registry.Remove<B>(entity); });
+      SYMPHONY_CHECK(queryAB.Size() == 0 && ViewMatches<A, B>(registry).empty());
+
+      // Add costs a signature check, an insert also looks the entity up in each pool, Remove probes the match set
+      const QueryStats& stats = queryAD.GetStats();
+      QueryStats before = stats;
+      Entity entity = registry.Create();
+      registry.Add<A>(entity);
+      registry.Remove<D>(entity);
+      registry.Add<D>(entity);
+      registry.Remove<D>(entity);
+      SYMPHONY_CHECK(stats.signatureChecks == before.signatureChecks + 2 && stats.probes == before.probes + 3);
+      SYMPHONY_CHECK(stats.inserts == before.inserts + 1 && stats.removes == before.removes + 1);
+
+      ThreadPool pool(3);
+      for (int i = 0; i < 10000; ++i)
+      {
+         Entity created = registry.Create();
+         registry.Add<A>(created, { int(created) });
+         registry.Add<B>(created, { int(created) });
+         if (i % 3 == 0)
+            registry.Add<C>(created);
+      }
+
+      std::atomic<size_t> visited = 0;
+      queryBA.ParallelForEach([&](Entity, B& b, A& a)
+      {
+         b.value = a.value + 1;
+         ++visited;
+      }, pool);
+
+      bool written = true;
+      registry.GetView<A, B>().ForEach([&](Entity, A& a, B& b) { written &= b.value == a.value + 1; });
+      SYMPHONY_CHECK(visited.load() == queryAB.Size() && queryAB.Size() == 10000 && written);
+   }
+
+   void QueryCostModelTests()
+   {
+      // Iterated often and rarely changed, the query beats re-filtering the pools every time
+      {
+         TestRegistry registry;
+         for (int i = 0; i < 1000; ++i)
+         {
+            Entity entity = registry.Create();
+            registry.Add<A>(entity);
+            registry.Add<B>(entity);
+            if (i % 10 == 0)
+               registry.Add<C>(entity);
+         }
+
+         auto query = registry.GetQuery<A, B, C>();
+         for (int i = 0; i < 100; ++i)
+            query.ForEach([](Entity, A&, B&, C&) {});
+
+         const QueryStats& stats = query.GetStats();
+         SYMPHONY_CHECK(stats.iterations == 100 && stats.visited == 10000 && stats.signatureChecksAvoided == 10000);
+         SYMPHONY_CHECK(stats.probesAvoided == 30000 && stats.PaysOff());
+      }
+
+      // Churned constantly and iterated once, the query costs more than it saves
+      {
+         TestRegistry registry;
+         std::vector<Entity> entities;
+         for (int i = 0; i < 1000; ++i)
+         {
+            entities.push_back(registry.Create());
+            registry.Add<A>(entities.back());
+         }
+
+         auto query = registry.GetQuery<A, B>();
+         for (int round = 0; round < 10; ++round)
+         {
+            for (Entity entity : entities)
+               registry.Add<B>(entity);
+            for (Entity entity : entities)
+               registry.Remove<B>(entity);
+         }
+         query.ForEach([](Entity, A&, B&) {});
+
+         const QueryStats& stats = query.GetStats();
+         SYMPHONY_CHECK(stats.inserts == 10000 && stats.removes == 10000 && !stats.PaysOff());
+
+         SYMPHONY_CHECK(stats.MaintenanceCost(QueryCosts { 0.0, 0.0, 1.0 }) == 20000.0);
+      }
+   }
+
+   // Measures the relative costs QueryCosts expects: a signature check by View, a PackedArray lookup by entity and a
+   // membership change of a query's match set, each over entities in random order
+   void QueryCostBenchmark()
+   {
+      constexpr Entity COUNT = 1 << 16;
+      constexpr int REPEATS = 20;
+
+      std::vector<Entity> order(COUNT);
+      std::iota(order.begin(), order.end(), Entity(0));
+      std::mt19937 rng(31);
+      std::shuffle(order.begin(), order.end(), rng);
+
+      auto nanosecondsPerOperation = [](size_t operations, auto&& body)
+      {
+         auto start = std::chrono::steady_clock::now();
+         body();
+         return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / double(operations);
+      };
+
+      TestRegistry registry;
+      for (Entity e = 0; e < COUNT; ++e)
+         registry.Create();
+      for (Entity entity : order)
+      {
+         registry.Add<A>(entity, { int(entity) });
+         if (entity % 2)
+            registry.Add<B>(entity);
+      }
+      std::shuffle(order.begin(), order.end(), rng);
+
+      size_t sink = 0;
+      double signatureCheck = nanosecondsPerOperation(size_t(COUNT) * REPEATS, [&]
+      {
+         for (int r = 0; r < REPEATS; ++r)
+         {
+            for (Entity entity : order)
+               sink += registry.Has<A, B>(entity);
+         }
+      });
+
+      auto& pool = registry.GetPool<A>();
+      double probe = nanosecondsPerOperation(size_t(COUNT) * REPEATS, [&]
+      {
+         for (int r = 0; r < REPEATS; ++r)
+         {
+            for (Entity entity : order)
+               sink += pool.Get(entity).value;
+         }
+      });
+
+      double membershipChange = nanosecondsPerOperation(size_t(COUNT) * 2 * REPEATS, [&]
+      {
+         for (int r = 0; r < REPEATS; ++r)
+         {
+            PackedArray<Entity, QueryMatch> matches;
+            for (Entity entity : order)
+               matches.Add(entity, QueryMatch());
+            for (auto it = order.rbegin(); it != order.rend(); ++it)
+               matches.Remove(*it);
+            sink += matches.Size();
+         }
+      });
+
+      std::printf("Query costs (%zu): signature check %.2f ns, probe %.2f ns (%.1fx), membership change %.2f ns (%.1fx)\n", sink % 10,
+         signatureCheck, probe, probe / signatureCheck, membershipChange, membershipChange / signatureCheck);
+   }
+}
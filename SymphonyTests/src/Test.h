@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdio>
+
+namespace SymphonyTests
+{
+   inline int& FailureCount()
+   {
+      static int failureCount = 0;
+      return failureCount;
+   }
+
+   void ConcurrentSparseSetStressTest();
+   void ConcurrentSparseSetBenchmark();
+   void ParallelTests();
+   void HierarchyArrayTests();
+   void DoubleBufferedArrayTests();
+   void QueryTests();
+   void QueryCostModelTests();
+   void QueryCostBenchmark();
+}
+
+#define SYMPHONY_CHECK(...)                                                                               \
+   do                                                                                                    \
+   {                                                                                                     \
+      if (!(__VA_ARGS__))                                                                                \
+      {                                                                                                  \
+         std::printf("[FAIL][%s:%d] %s\n", __FILE__, __LINE__, #__VA_ARGS__);                           \
+         ++SymphonyTests::FailureCount();                                                                \
+      }                                                                                                  \
+   } while (false)
@@ -18,7 +18,7 @@ workspace "Symphony"
     outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
     
     IncludeDir = {}
-    IncludeDir["Symphony"] = "src"
+    IncludeDir["Symphony"] = "Symphony/src"
     -- IncludeDir["GoogleTest"] = "vendor/googletest/include"
     
     group "Dependencies"
@@ -86,7 +86,7 @@ workspace "Symphony"
 
         links {
             "Symphony",
-            "gtest"
+            -- "gtest"
         }
 
         defines { "_CRT_SECURE_NO_WARNINGS" }